@@ -0,0 +1,55 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "allocation.h"
+
+/* The failure handler of each thread */
+static pthread_key_t handlerKey;
+static pthread_once_t handlerKeyOnce = PTHREAD_ONCE_INIT;
+
+/* Creates the key of the failure handlers, once for the whole process. */
+static void createHandlerKey(void) {
+    pthread_key_create(&handlerKey, NULL);
+}
+
+/* Jumps to the failure handler of the thread, or exits when it has none. */
+static void allocationFailed(void) {
+    jmp_buf *handler;
+
+    pthread_once(&handlerKeyOnce, createHandlerKey);
+    handler = (jmp_buf *) pthread_getspecific(handlerKey);
+    if (handler != NULL) {
+        longjmp(*handler, 1);
+    }
+    fprintf(stderr, "Memory allocation failed\n");
+    exit(EXIT_FAILURE);
+}
+
+/* Allocates a block of memory. */
+void *allocateMemory(size_t size) {
+    void *block = malloc(size > 0 ? size : 1);
+    if (block == NULL) {
+        allocationFailed();
+    }
+    return block;
+}
+
+/* Resizes a block of memory. */
+void *reallocateMemory(void *block, size_t size) {
+    void *resized = realloc(block, size > 0 ? size : 1);
+    if (resized == NULL) {
+        allocationFailed();
+    }
+    return resized;
+}
+
+/* Sets the failure handler of the calling thread. */
+jmp_buf *setAllocationHandler(jmp_buf *handler) {
+    jmp_buf *previous;
+
+    pthread_once(&handlerKeyOnce, createHandlerKey);
+    previous = (jmp_buf *) pthread_getspecific(handlerKey);
+    pthread_setspecific(handlerKey, handler);
+    return previous;
+}
@@ -0,0 +1,39 @@
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include <setjmp.h>
+#include <stddef.h>
+
+/*
+ * Allocates a block of memory.
+ *
+ * When the allocation fails, control goes back to the failure handler of the calling
+ * thread with longjmp. A thread without a handler prints an error and exits, which is
+ * what the command line tools want.
+ *
+ * @param size The number of bytes to allocate.
+ * @return The allocated block, never NULL.
+ */
+void *allocateMemory(size_t size);
+
+/*
+ * Resizes a block of memory, like realloc.
+ *
+ * When the allocation fails the block is left as it was and control goes to the
+ * failure handler, as in allocateMemory.
+ *
+ * @param block The block to resize, or NULL.
+ * @param size The new size of the block.
+ * @return The resized block, never NULL.
+ */
+void *reallocateMemory(void *block, size_t size);
+
+/*
+ * Sets the failure handler of the calling thread.
+ *
+ * @param handler The jump buffer an allocation failure jumps to, or NULL to exit on failure.
+ * @return The previous handler of the thread, to be restored by the caller.
+ */
+jmp_buf *setAllocationHandler(jmp_buf *handler);
+
+#endif
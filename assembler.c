@@ -3,109 +3,184 @@
  *
  * Description:
  * This program is a basic assembler for a hypothetical machine.
- * It reads assembly source files, processes them through two passes
- * of the assembler, and generates output files with the machine code.
+ * It reads assembly source files, processes them in a single pass
+ * whose forward references are resolved through a fixup list, and
+ * generates output files with the machine code. The assembler itself
+ * is the library of libassembler.h, which works on buffers in memory;
+ * this program maps the source files and writes the buffers out.
  *
  * Author: Yarden Deshe
  * Mmn 14
  *
  * Compilation:
- * - To compile this program, use a C compiler like `gcc`:
- *   gcc -o assembler assembler.c
+ * - To compile this program, run `make`.
+ * - `make` also builds libassembler.a: include libassembler.h and link it with -pthread
+ *   to assemble sources held in memory within another program.
+ * - To time each stage on generated programs of growing size, run `make bench`.
  *
  * Usage:
  * - To run the program, execute the compiled binary with one or more source files:
  *   ./assembler sourcefile1.asm sourcefile2.asm
+ * - To assemble the files on N worker threads:
+ *   ./assembler -j N sourcefile1.asm sourcefile2.asm
+ * - To also write the source after macro expansion to a .am file:
+ *   ./assembler --keep-am sourcefile1.asm
+ * - To print the timing of each phase and the counters of each file as JSON lines:
+ *   ./assembler --stats=json sourcefile1.asm sourcefile2.asm
+ * - To write one binary object file (.bin) instead of the .ob, .ent and .ext files:
+ *   ./assembler --format=bin sourcefile1.asm
+ *   ./objconv --to-text sourcefile1.bin converts it back, ./objconv --to-bin sourcefile1.ob
+ *   converts the text files to it.
+ * - To also write a .rel file listing the address of every relocatable word, so that
+ *   ./rebase can move the program to another base without assembling it again:
+ *   ./assembler --rel sourcefile1.asm
+ * - To also write a .map file giving the source line of the code addresses, which
+ *   ./simulator --profile uses to report the hot spots of a program by line:
+ *   ./assembler --map sourcefile1.asm
+ * - To keep running and assemble the files named by requests on stdin, answering on stdout,
+ *   or on the clients of a Unix domain socket (see server.h for the requests):
+ *   ./assembler --serve
+ *   ./assembler --serve=/tmp/assembler.sock
+ * - To keep the files of every source that assembles without errors in a cache directory,
+ *   and restore them instead of assembling an unchanged source again (see cache.h):
+ *   ./assembler --cache=.asmcache sourcefile1.asm sourcefile2.asm
  */
 
 
 #include <ctype.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "assembler.h"
-#include "preProcessor.h"
-#include "firstRun.h"
-#include "secondRun.h"
+#include "libassembler.h"
 #include "outputFiles.h"
+#include "server.h"
+#include "sourceReader.h"
+#include "statistics.h"
 
 
+/* Shared state of the worker pool used by the -j mode. */
+typedef struct {
+    char **fileNames;        /* Source files to assemble */
+    assemblerOptions *options; /* Options applied to every file */
+    int fileCount;           /* Number of source files */
+    int next;                /* Index of the next file to hand out */
+    pthread_mutex_t lock;    /* Protects next */
+} workQueue;
 
-/*
-void printBinary15Bits(short value) {
-    int i;
-    char binaryString[16];
-    binaryString[15] = '\0';
+static pthread_mutex_t outputLock = PTHREAD_MUTEX_INITIALIZER;
 
+/* Number of files by use of the cache, counted under outputLock */
+static int cacheCounts[CACHE_INVALID + 1];
 
-    for (i = 0; i < 15; i++) {
-        binaryString[i] = (value & (1 << (14 - i))) ? '1' : '0';
+/*
+ * Assembles a single source file into its output files.
+ * All the state of the assembly is in the context, so several files may be assembled at once
+ * with a context each.
+ * @param sourceFileName The name of the source file.
+ * @param options The command line options.
+ * @param context The context of the calling thread.
+ */
+void assembleFile(char *sourceFileName, assemblerOptions *options, assemblerContext *context) {
+    sourceBuffer source;
+    assemblyResult *result;
+
+    /* Map the source file, the library reads it in place */
+    if (!openSourceBuffer(sourceFileName, &source)) {
+        printf("Error opening source file: %s\n", sourceFileName);
+        return;
+    }
+    result = assembleBuffer(context, source.text, source.length, options);
+    if (result->status == ASSEMBLY_SUCCESS || result->status == ASSEMBLY_ERRORS) {
+        writeAssemblyFiles(sourceFileName, result, options);
     }
-    printf("%s", binaryString);
-}
 
+    /* Keep the errors and the record of each file together when files are assembled in parallel */
+    pthread_mutex_lock(&outputLock);
+    printDiagnostics(stderr, &result->diagnostics);
+    cacheCounts[result->stats.cacheStatus]++;
+    if (result->status == ASSEMBLY_EXPANSION_FAILED) {
+        fprintf(stderr, "Error expanding macros for file: %s\n", sourceFileName);
+    } else if (result->status == ASSEMBLY_OUT_OF_MEMORY) {
+        fprintf(stderr, "Memory allocation failed for file: %s\n", sourceFileName);
+    } else if (options->printStats) {
+        printStatsJson(stdout, sourceFileName, &result->stats);
+    }
+    pthread_mutex_unlock(&outputLock);
 
-void printDetailedListItems(instructionList *Ilist, dataList *Dlist, int codeLength) {
-    instructionList *currentInstruction = Ilist;
-    dataList *currentData = Dlist;
+    closeSourceBuffer(&source);
+}
 
-    printf("Detailed Instruction List:\n");
-    printf("Address\tBinary\t\tOctal\tValue\tOperand\n");
-    if (currentInstruction == NULL) {
-        printf("Instruction List is empty.\n");
-    } else {
-        while (currentInstruction != NULL) {
-            if (currentInstruction->line != 0) {
-                printf("%04d\t", currentInstruction->count);
-                printBinary15Bits((short)currentInstruction->line);
-                printf("\t%05o\t%05o\t%s\n",
-                    currentInstruction->line, currentInstruction->line,
-                    currentInstruction->symbolOperand ? currentInstruction->symbolOperand : "NULL");
-            } else {
-                printf("NULL\n");
-            }
-            currentInstruction = currentInstruction->next;
-        }
-    }
+/* Worker thread: takes files from the queue until it is empty. */
+void *assembleWorker(void *arg) {
+    workQueue *queue = (workQueue *) arg;
+    assemblerContext *context = initAssemblerContext();
+    int index;
 
+    if (context == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return NULL;
+    }
 
-    printf("\nDetailed Data List:\n");
-    printf("Address\tBinary\t\tOctal\tValue\n");
-    if (currentData == NULL) {
-        printf("Data List is empty.\n");
-    } else {
-        while (currentData->next != NULL) {
-            printf("%04d\t", currentData->count + codeLength);
-            printBinary15Bits((short)currentData->line);
-            printf("\t%05o\t%05o\n",
-                (currentData->count + codeLength), currentData->line);
+    while (true) {
+        pthread_mutex_lock(&queue->lock);
+        index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
 
-            currentData = currentData->next;
+        if (index >= queue->fileCount) {
+            break;
         }
+        assembleFile(queue->fileNames[index], queue->options, context);
     }
+    freeAssemblerContext(context);
+    return NULL;
 }
 
+/*
+ * Assembles the files on a pool of worker threads.
+ * Falls back to the calling thread for any worker that could not be started.
+ * @param fileNames The source files to assemble.
+ * @param fileCount The number of source files.
+ * @param options The command line options, including the number of worker threads.
+ */
+void assembleFilesInParallel(char **fileNames, int fileCount, assemblerOptions *options) {
+    workQueue queue;
+    pthread_t *workers;
+    int i, started = 0, jobs = options->jobs;
+
+    queue.fileNames = fileNames;
+    queue.options = options;
+    queue.fileCount = fileCount;
+    queue.next = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    if (jobs > fileCount) {
+        jobs = fileCount;
+    }
 
-void printLists(instructionList *Ilist, dataList *Dlist, int codeLength) {
-    instructionList *currentInstruction = Ilist;
-    dataList *currentData = Dlist;
+    workers = malloc(sizeof(pthread_t) * jobs);
+    if (workers != NULL) {
+        for (i = 0; i < jobs; i++) {
+            if (pthread_create(&workers[started], NULL, assembleWorker, &queue) == 0) {
+                started++;
+            }
+        }
+    }
 
-    printf("Instruction List:\n");
-    printf("Address\tValue\n");
-    while (currentInstruction != NULL && currentInstruction->count != 0) {
-        printf("%04d\t%05o\n", currentInstruction->count, currentInstruction->line);
-        currentInstruction = currentInstruction->next;
+    /* Make sure every file is assembled even if no worker could be created */
+    if (started == 0) {
+        assembleWorker(&queue);
     }
 
-    printf("\nData List:\n");
-    printf("Address\tValue\n");
-    while (currentData != NULL && currentData->count != 0) {
-        printf("%04d\t%05o\n", currentData->count + codeLength, currentData->line);
-        currentData = currentData->next;
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
     }
-}
-*/
 
+    free(workers);
+    pthread_mutex_destroy(&queue.lock);
+}
 
 /*
  * Main function to execute the program.
@@ -114,70 +189,101 @@ void printLists(instructionList *Ilist, dataList *Dlist, int codeLength) {
  * @return 0 if successful, otherwise 1.
  */
 int main(int argc, char *argv[]) {
-    int i;
+    int i, first = 1, status = 0;
+    assemblerOptions options;
+    assemblerContext *context;
+
+    options.jobs = 1;
+    options.keepExpandedFile = false;
+    options.printStats = false;
+    options.objectFormat = FORMAT_TEXT;
+    options.writeRelocations = false;
+    options.writeLineMap = false;
+    options.serve = false;
+    options.socketPath = NULL;
+    options.cacheDirectory = NULL;
+
+    /* Parse the options given before the file names */
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "--keep-am") == 0) {
+            options.keepExpandedFile = true;
+        } else if (strcmp(argv[first], "--stats=json") == 0) {
+            options.printStats = true;
+        } else if (strcmp(argv[first], "--format=text") == 0) {
+            options.objectFormat = FORMAT_TEXT;
+        } else if (strcmp(argv[first], "--format=bin") == 0) {
+            options.objectFormat = FORMAT_BINARY;
+        } else if (strcmp(argv[first], "--rel") == 0) {
+            options.writeRelocations = true;
+        } else if (strcmp(argv[first], "--map") == 0) {
+            options.writeLineMap = true;
+        } else if (strcmp(argv[first], "--serve") == 0) {
+            options.serve = true;
+        } else if (strncmp(argv[first], "--serve=", 8) == 0 && argv[first][8] != '\0') {
+            options.serve = true;
+            options.socketPath = argv[first] + 8;
+        } else if (strncmp(argv[first], "--cache=", 8) == 0 && argv[first][8] != '\0') {
+            options.cacheDirectory = argv[first] + 8;
+        } else if (strncmp(argv[first], "-j", 2) == 0) {
+            /* The number of jobs is given as -j N or -jN */
+            if (argv[first][2] != '\0') {
+                options.jobs = atoi(argv[first] + 2);
+            } else if (first + 1 < argc) {
+                options.jobs = atoi(argv[++first]);
+            } else {
+                options.jobs = 0;
+            }
 
-    /* Check if at least one input file is provided */
-    if (argc < 2) {
-        printf("Usage: %s <input file 1> [<input file 2> ...]\n", argv[0]);
-        return 1;
+            if (options.jobs < 1) {
+                printf("Invalid number of jobs\n");
+                return 1;
+            }
+        } else {
+            printf("Unknown option: %s\n", argv[first]);
+            return 1;
+        }
+        first++;
     }
 
-    for (i = 1; i < argc; i++) {
-
-        int IC = INITIAL_IC, DC = INITIAL_DC;
-        char *outputFileName;
-        FILE *sourceFile, *outputFile = NULL;
-        symbolTable *symTable;
-        instructionList *Ihead, *Itail;
-        dataList *Dhead, *Dtail;
+    /* Check if at least one input file is provided, or none when serving */
+    if (options.serve ? argc - first > 0 : argc - first < 1) {
+        printf("Usage: %s [-j <jobs>] [--keep-am] [--stats=json] [--format=text|bin] [--rel] [--map] [--cache=<dir>] <input file 1> [<input file 2> ...]\n"
+               "       %s [--keep-am] [--stats=json] [--format=text|bin] [--rel] [--map] [--cache=<dir>] --serve[=<socket>]\n", argv[0], argv[0]);
+        return 1;
+    }
 
-        /* Open the source file */
-        sourceFile = fopen(argv[i], "r");
-        if (sourceFile == NULL) {
-            printf("Error opening source file: %s\n", argv[i]);
-            continue;
+    if (options.serve) {
+        context = initAssemblerContext();
+        if (context == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            return 1;
         }
-
-        /* Prepare output file name with changed extension and expand macros */
-        outputFileName = changeFileExtension(argv[i], ".am");
-        if (!expandMacros(sourceFile, outputFile, outputFileName)) {
-            fprintf(stderr, "Error expanding macros for file: %s\n", argv[i]);
+        if (options.socketPath != NULL) {
+            status = serveSocket(options.socketPath, context, &options) ? 0 : 1;
+        } else {
+            serveStream(stdin, stdout, context, &options);
         }
-        else {
-            /* Initialize symbol table and lists */
-            symTable = initSymbolTable();
-            Ihead = initInstructionList();
-            Itail = Ihead;
-            Dhead = initDataList();
-            Dtail = Dhead;
-
-            /* Perform the first assembler pass */
-            firstAssemblerPass( outputFileName, symTable, &Itail, &Dtail, &IC, &DC);
-
-            Itail = Ihead;
-            Dtail = Dhead;
-
-            /* Perform the second assembler pass */
-            secondAssemblerPass( outputFileName, symTable,  &Itail);
-
-            Itail = Ihead;
-
-            /* Create the output files and print the lists */
-            createOutputFiles(argv[i], Itail, Dtail, IC, DC, symTable);
-            /*
-            printDetailedListItems(Ihead, Dhead, IC);  //todo delete debug only
-*/
-            /* Free the memory allocated */
-            freeInstructionList(Ihead);
-            freeDataList(Dhead);
-            printSymbolTable(symTable); //todo delete debug only
-            freeSymbolTable(symTable);
+        freeAssemblerContext(context);
+        return status;
+    }
 
+    if (options.jobs > 1) {
+        assembleFilesInParallel(argv + first, argc - first, &options);
+    } else {
+        context = initAssemblerContext();
+        if (context == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            return 1;
         }
-        /* Close the source file and output file */
-        fclose(sourceFile);
+        for (i = first; i < argc; i++) {
+            assembleFile(argv[i], &options, context);
+        }
+        freeAssemblerContext(context);
+    }
 
-        free(outputFileName);
+    if (options.cacheDirectory != NULL) {
+        fprintf(stderr, "Cache: %d hits, %d misses, %d invalid entries\n",
+                cacheCounts[CACHE_HIT], cacheCounts[CACHE_MISS], cacheCounts[CACHE_INVALID]);
     }
     return 0;
 }
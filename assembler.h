@@ -2,7 +2,26 @@
 #define ASSEMBLER_H
 
 
+#include <stdbool.h>
+
 #define INITIAL_IC 100
 #define INITIAL_DC 0
 
+/* Object file formats */
+#define FORMAT_TEXT 0             /* The .ob, .ent and .ext text files */
+#define FORMAT_BINARY 1           /* One binary object file, see objectFile.h */
+
+/* Options given on the command line. */
+typedef struct {
+    int jobs;                 /* Number of files assembled in parallel */
+    bool keepExpandedFile;    /* Write the .am file with the expanded macros */
+    bool printStats;          /* Print the timing and counters of each file as JSON */
+    int objectFormat;         /* FORMAT_TEXT or FORMAT_BINARY */
+    bool writeRelocations;    /* Write the .rel file listing the relocatable words */
+    bool writeLineMap;        /* Write the .map file giving the source line of the code addresses */
+    bool serve;               /* Answer assemble requests instead of assembling the given files */
+    char *socketPath;         /* The Unix socket the requests come from, NULL for stdin and stdout */
+    char *cacheDirectory;     /* The directory caching assembled sources, NULL for no cache */
+} assemblerOptions;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+/*
+ * benchmark.c
+ *
+ * Description:
+ * Times each stage of the assembler (macro expansion, first pass, fixup resolution
+ * and output files) on the given source files and reports the throughput and the peak
+ * resident set size of the process.
+ *
+ * Usage:
+ *   ./benchmark --header
+ *   ./benchmark sourcefile1.as [sourcefile2.as ...]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "assembler.h"
+#include "libassembler.h"
+#include "outputFiles.h"
+#include "sourceReader.h"
+#include "statistics.h"
+
+/* Stages of the assembler that are timed */
+#define STAGES 4
+#define STAGE_EXPAND 0
+#define STAGE_FIRST_PASS 1
+#define STAGE_RESOLVE 2
+#define STAGE_OUTPUT 3
+
+/* Returns the peak resident set size of the process in kilobytes. */
+static long peakResidentSetKB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/* Prints the names of the columns reported for each file. */
+static void printHeader() {
+    printf("%-32s %10s %10s %9s %9s %9s %9s %9s %12s %12s %10s\n",
+           "file", "lines", "words", "expand", "pass1", "resolve", "output", "total",
+           "lines/s", "words/s", "peakKB");
+}
+
+/*
+ * Assembles one source file the same way assembleFile does, timing every stage.
+ * @param sourceFileName The name of the source file.
+ * @param context The assembler context.
+ * @return true if the file was assembled, false otherwise.
+ */
+static bool benchmarkFile(char *sourceFileName, assemblerContext *context) {
+    assemblerOptions options;
+    assemblyResult *result;
+    sourceBuffer source;
+    double times[STAGES], total = 0;
+    int stage;
+
+    if (!openSourceBuffer(sourceFileName, &source)) {
+        fprintf(stderr, "Error opening source file: %s\n", sourceFileName);
+        return false;
+    }
+
+    options.jobs = 1;
+    options.keepExpandedFile = false;
+    options.printStats = false;
+    options.objectFormat = FORMAT_TEXT;
+    options.writeRelocations = false;
+    options.writeLineMap = false;
+    options.cacheDirectory = NULL;
+    result = assembleBuffer(context, source.text, source.length, &options);
+    if (result->status == ASSEMBLY_EXPANSION_FAILED || result->status == ASSEMBLY_OUT_OF_MEMORY) {
+        fprintf(stderr, "Error expanding macros for file: %s\n", sourceFileName);
+        closeSourceBuffer(&source);
+        return false;
+    }
+
+    /* The output stage formats the files and writes them */
+    writeAssemblyFiles(sourceFileName, result, &options);
+
+    times[STAGE_EXPAND] = result->stats.expandTime;
+    times[STAGE_FIRST_PASS] = result->stats.firstPassTime;
+    times[STAGE_RESOLVE] = result->stats.resolveTime;
+    times[STAGE_OUTPUT] = result->stats.outputTime;
+    for (stage = 0; stage < STAGES; stage++) {
+        total += times[stage];
+    }
+
+    printf("%-32s %10ld %10ld %9.4f %9.4f %9.4f %9.4f %9.4f %12.0f %12.0f %10ld\n",
+           sourceFileName, result->stats.linesRead, result->stats.wordsEmitted, times[STAGE_EXPAND],
+           times[STAGE_FIRST_PASS], times[STAGE_RESOLVE], times[STAGE_OUTPUT], total,
+           total > 0 ? result->stats.linesRead / total : 0.0,
+           total > 0 ? result->stats.wordsEmitted / total : 0.0, peakResidentSetKB());
+    fflush(stdout);
+
+    closeSourceBuffer(&source);
+    return true;
+}
+
+/*
+ * Main function of the benchmark.
+ * @param argc The number of command-line arguments.
+ * @param argv --header, or the source files to assemble.
+ * @return 0 if every file was assembled, otherwise 1.
+ */
+int main(int argc, char *argv[]) {
+    int i, status = 0;
+    assemblerContext *context;
+
+    if (argc < 2) {
+        printf("Usage: %s --header | <input file 1> [<input file 2> ...]\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "--header") == 0) {
+        printHeader();
+        return 0;
+    }
+
+    context = initAssemblerContext();
+    if (context == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    for (i = 1; i < argc; i++) {
+        if (!benchmarkFile(argv[i], context)) {
+            status = 1;
+        }
+    }
+    freeAssemblerContext(context);
+    return status;
+}
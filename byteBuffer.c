@@ -0,0 +1,54 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "byteBuffer.h"
+
+/* Initializes an empty buffer. */
+void initByteBuffer(byteBuffer *buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+/* Makes room for bytes at the end of the buffer. */
+char *extendByteBuffer(byteBuffer *buffer, long count) {
+    char *end;
+
+    /* Grow the buffer geometrically */
+    if (buffer->length + count > buffer->capacity) {
+        long capacity = buffer->capacity ? buffer->capacity : INITIAL_BYTE_BUFFER;
+        while (capacity < buffer->length + count) {
+            capacity *= 2;
+        }
+        buffer->data = reallocateMemory(buffer->data, capacity);
+        buffer->capacity = capacity;
+    }
+
+    end = buffer->data + buffer->length;
+    buffer->length += count;
+    return end;
+}
+
+/* Appends bytes to the end of the buffer. */
+void appendBytes(byteBuffer *buffer, const char *bytes, long count) {
+    memcpy(extendByteBuffer(buffer, count), bytes, count);
+}
+
+/* Writes a 16 bit little-endian field. */
+void store16(unsigned char *p, unsigned value) {
+    p[0] = (unsigned char) (value & 0xFF);
+    p[1] = (unsigned char) ((value >> 8) & 0xFF);
+}
+
+/* Writes a 32 bit little-endian field. */
+void store32(unsigned char *p, unsigned long value) {
+    store16(p, (unsigned) (value & 0xFFFF));
+    store16(p + 2, (unsigned) ((value >> 16) & 0xFFFF));
+}
+
+/* Frees the bytes of a buffer and leaves it empty. */
+void freeByteBuffer(byteBuffer *buffer) {
+    free(buffer->data);
+    initByteBuffer(buffer);
+}
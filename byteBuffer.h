@@ -0,0 +1,68 @@
+#ifndef BYTE_BUFFER_H
+#define BYTE_BUFFER_H
+
+#define INITIAL_BYTE_BUFFER 4096
+
+/* Little-endian fields of the binary files */
+#define LOAD16(p) ((unsigned) (p)[0] | (unsigned) (p)[1] << 8)
+#define LOAD32(p) ((unsigned long) LOAD16(p) | (unsigned long) LOAD16((p) + 2) << 16)
+
+/* Structure representing a growing block of bytes, such as the text of an output file. */
+typedef struct {
+    char *data;               /* The bytes, not null terminated */
+    long length;              /* Number of bytes used */
+    long capacity;            /* Number of bytes data can hold */
+} byteBuffer;
+
+/*
+ * Initializes an empty buffer.
+ *
+ * @param buffer The buffer to initialize.
+ */
+void initByteBuffer(byteBuffer *buffer);
+
+/*
+ * Makes room for bytes at the end of the buffer.
+ *
+ * The buffer grows geometrically and its length includes the new bytes, which the
+ * caller fills in.
+ *
+ * @param buffer The buffer to extend.
+ * @param count The number of bytes to add.
+ * @return Where the new bytes start.
+ */
+char *extendByteBuffer(byteBuffer *buffer, long count);
+
+/*
+ * Appends bytes to the end of the buffer.
+ *
+ * @param buffer The buffer to append to.
+ * @param bytes The bytes to append.
+ * @param count The number of bytes.
+ */
+void appendBytes(byteBuffer *buffer, const char *bytes, long count);
+
+/*
+ * Writes a 16 bit little-endian field.
+ *
+ * @param p Where the field starts.
+ * @param value The value of the field.
+ */
+void store16(unsigned char *p, unsigned value);
+
+/*
+ * Writes a 32 bit little-endian field.
+ *
+ * @param p Where the field starts.
+ * @param value The value of the field.
+ */
+void store32(unsigned char *p, unsigned long value);
+
+/*
+ * Frees the bytes of a buffer and leaves it empty.
+ *
+ * @param buffer The buffer to free.
+ */
+void freeByteBuffer(byteBuffer *buffer);
+
+#endif
@@ -0,0 +1,205 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "allocation.h"
+#include "cache.h"
+#include "objectFile.h"
+#include "processorUtils.h"
+#include "sourceReader.h"
+#include "statistics.h"
+
+/* Returns the flags of the options adding files to an entry. */
+static unsigned optionFlags(const assemblerOptions *options) {
+    return (options->keepExpandedFile ? CACHE_HAS_EXPANDED : 0) |
+           (options->writeRelocations ? CACHE_HAS_RELOCATIONS : 0) |
+           (options->writeLineMap ? CACHE_HAS_LINE_MAP : 0);
+}
+
+/* Lists the files of an entry in the order of the entry, NULL for the .am file when it is not kept. */
+static void entryFiles(const assemblerOptions *options, objectBuffers *output, byteBuffer *expanded,
+                       byteBuffer **files) {
+    files[0] = &output->object;
+    files[1] = &output->entries;
+    files[2] = &output->externals;
+    files[3] = &output->relocations;
+    files[4] = &output->lineMap;
+    files[5] = options->keepExpandedFile ? expanded : NULL;
+}
+
+/* Returns the path of the entry of a source, named after the hash of everything that changes its files. */
+static char *entryPath(const char *directory, const char *source, long length, const assemblerOptions *options) {
+    unsigned char key[8];
+    unsigned long hash;
+    char *path;
+
+    store16(key, CACHE_VERSION);
+    store16(key + 2, OBJECT_VERSION);
+    store16(key + 4, (unsigned) options->objectFormat);
+    store16(key + 6, optionFlags(options));
+    hash = continueHash(continueHash(HASH_OFFSET_BASIS, (char *) key, sizeof(key)), source, length);
+
+    /* The length tells apart most of the sources that share a hash */
+    path = allocateMemory(strlen(directory) + CACHE_KEY_LENGTH + 2);
+    sprintf(path, "%s/%08lx%08lx", directory, hash, (unsigned long) length & 0xFFFFFFFFUL);
+    return path;
+}
+
+/* Checks the header and the checksum of a mapped entry, and that it holds the given source. */
+static bool validEntry(sourceBuffer *entry, const char *source, long length, const assemblerOptions *options) {
+    const unsigned char *header = (const unsigned char *) entry->text;
+    unsigned long size = CACHE_HEADER_SIZE + (unsigned long) length, hash;
+    int i;
+
+    if (entry->length < CACHE_HEADER_SIZE || memcmp(header, CACHE_MAGIC, 4) != 0 ||
+        LOAD16(header + 4) != CACHE_VERSION || LOAD16(header + 6) != OBJECT_VERSION ||
+        LOAD16(header + 8) != (unsigned) options->objectFormat ||
+        (LOAD16(header + 10) & (CACHE_HAS_EXPANDED | CACHE_HAS_RELOCATIONS | CACHE_HAS_LINE_MAP)) !=
+            optionFlags(options) ||
+        LOAD32(header + 12) != (unsigned long) length) {
+        return false;
+    }
+
+    /* The lengths must add up to the size of the entry */
+    for (i = 0; i < CACHE_FILES; i++) {
+        size += LOAD32(header + CACHE_LENGTHS_OFFSET + 4 * i);
+    }
+    if (size != (unsigned long) entry->length) {
+        return false;
+    }
+
+    hash = continueHash(HASH_OFFSET_BASIS, entry->text, CACHE_CHECKSUM_OFFSET);
+    hash = continueHash(hash, entry->text + CACHE_HEADER_SIZE, entry->length - CACHE_HEADER_SIZE);
+    return hash == LOAD32(header + CACHE_CHECKSUM_OFFSET) &&
+           memcmp(entry->text + CACHE_HEADER_SIZE, source, length) == 0;
+}
+
+/* Restores the output files of a source from the cache. */
+int loadCacheEntry(const char *directory, const char *source, long length, const assemblerOptions *options,
+                   objectBuffers *output, byteBuffer *expanded) {
+    byteBuffer *files[CACHE_FILES];
+    const unsigned char *header;
+    const char *file;
+    sourceBuffer entry;
+    unsigned long fileLength;
+    char *path;
+    int flags, i;
+
+    path = entryPath(directory, source, length, options);
+    if (!openSourceBuffer(path, &entry)) {
+        free(path);
+        return CACHE_MISS;
+    }
+    free(path);
+    if (!validEntry(&entry, source, length, options)) {
+        closeSourceBuffer(&entry);
+        return CACHE_INVALID;
+    }
+
+    /* Copy the files out of the mapping */
+    header = (const unsigned char *) entry.text;
+    flags = (int) LOAD16(header + 10);
+    output->format = options->objectFormat;
+    output->hasEntries = (flags & CACHE_HAS_ENTRIES) != 0;
+    output->hasExternals = (flags & CACHE_HAS_EXTERNALS) != 0;
+    output->hasRelocations = (flags & CACHE_HAS_RELOCATIONS) != 0;
+    output->hasLineMap = (flags & CACHE_HAS_LINE_MAP) != 0;
+
+    entryFiles(options, output, expanded, files);
+    file = entry.text + CACHE_HEADER_SIZE + length;
+    for (i = 0; i < CACHE_FILES; i++) {
+        fileLength = LOAD32(header + CACHE_LENGTHS_OFFSET + 4 * i);
+        if (files[i] != NULL) {
+            appendBytes(files[i], file, (long) fileLength);
+        }
+        file += fileLength;
+    }
+
+    closeSourceBuffer(&entry);
+    return CACHE_HIT;
+}
+
+/* Writes all the bytes to a file descriptor. */
+static bool writeAll(int fd, const char *bytes, long count) {
+    ssize_t written;
+
+    while (count > 0) {
+        written = write(fd, bytes, count);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        count -= written;
+    }
+    return true;
+}
+
+/* Stores the output files of a source in the cache. */
+bool storeCacheEntry(const char *directory, const char *source, long length, const assemblerOptions *options,
+                     objectBuffers *output, byteBuffer *expanded) {
+    unsigned char header[CACHE_HEADER_SIZE];
+    byteBuffer *files[CACHE_FILES];
+    unsigned long hash;
+    char *path, *temporary;
+    bool written;
+    int fd, i;
+
+    entryFiles(options, output, expanded, files);
+    memcpy(header, CACHE_MAGIC, 4);
+    store16(header + 4, CACHE_VERSION);
+    store16(header + 6, OBJECT_VERSION);
+    store16(header + 8, (unsigned) output->format);
+    store16(header + 10, (output->hasEntries ? CACHE_HAS_ENTRIES : 0) |
+                         (output->hasExternals ? CACHE_HAS_EXTERNALS : 0) | optionFlags(options));
+    store32(header + 12, (unsigned long) length);
+    for (i = 0; i < CACHE_FILES; i++) {
+        store32(header + CACHE_LENGTHS_OFFSET + 4 * i, files[i] != NULL ? (unsigned long) files[i]->length : 0);
+    }
+
+    hash = continueHash(HASH_OFFSET_BASIS, (char *) header, CACHE_CHECKSUM_OFFSET);
+    hash = continueHash(hash, source, length);
+    for (i = 0; i < CACHE_FILES; i++) {
+        if (files[i] != NULL) {
+            hash = continueHash(hash, files[i]->data, files[i]->length);
+        }
+    }
+    store32(header + CACHE_CHECKSUM_OFFSET, hash);
+
+    /* Write a file of its own, then rename it over the entry in one step */
+    if (mkdir(directory, 0777) != 0 && errno != EEXIST) {
+        return false;
+    }
+    path = entryPath(directory, source, length, options);
+    temporary = allocateMemory(strlen(path) + 8);
+    sprintf(temporary, "%s.XXXXXX", path);
+    fd = mkstemp(temporary);
+    if (fd < 0) {
+        free(temporary);
+        free(path);
+        return false;
+    }
+    fchmod(fd, 0644);
+
+    written = writeAll(fd, (char *) header, CACHE_HEADER_SIZE) && writeAll(fd, source, length);
+    for (i = 0; written && i < CACHE_FILES; i++) {
+        if (files[i] != NULL) {
+            written = writeAll(fd, files[i]->data, files[i]->length);
+        }
+    }
+    written = close(fd) == 0 && written && rename(temporary, path) == 0;
+    if (!written) {
+        unlink(temporary);
+    }
+
+    free(temporary);
+    free(path);
+    return written;
+}
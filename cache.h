@@ -0,0 +1,81 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+
+#include "assembler.h"
+#include "byteBuffer.h"
+#include "outputFiles.h"
+
+/*
+ * Cache of assembled sources (--cache=DIR).
+ *
+ * An entry holds the output files of a source that assembled without errors. It is
+ * named after a hash of the source, of CACHE_VERSION and OBJECT_VERSION and of the
+ * options changing the files, so a source assembled again with the same assembler
+ * finds the files of its last assembly. Entry file, all numbers little-endian:
+ *
+ *   offset  size  field
+ *        0     4  magic "ASMC"
+ *        4     2  cache version
+ *        6     2  object format version
+ *        8     2  object format, FORMAT_TEXT or FORMAT_BINARY
+ *       10     2  flags (CACHE_HAS_ENTRIES, CACHE_HAS_EXTERNALS, CACHE_HAS_EXPANDED,
+ *                 CACHE_HAS_RELOCATIONS, CACHE_HAS_LINE_MAP)
+ *       12     4  length of the source
+ *       16    24  length of each of the CACHE_FILES files: the .ob file or the binary
+ *                 object file, the .ent, .ext, .rel, .map and .am files
+ *       40     4  checksum, the FNV-1a hash of every other byte of the entry
+ *       44        the source, then the files in the order of their lengths
+ *
+ * The source is kept so that a hit is only taken for the very same text, not for
+ * another source with the same hash. An entry that fails any check is ignored and
+ * replaced once the source is assembled.
+ */
+#define CACHE_MAGIC "ASMC"
+#define CACHE_VERSION 3           /* Raise whenever the files produced for a source change */
+#define CACHE_FILES 6
+#define CACHE_LENGTHS_OFFSET 16
+#define CACHE_CHECKSUM_OFFSET (CACHE_LENGTHS_OFFSET + 4 * CACHE_FILES)
+#define CACHE_HEADER_SIZE (CACHE_CHECKSUM_OFFSET + 4)
+#define CACHE_KEY_LENGTH 16       /* Hexadecimal digits naming an entry */
+
+/* Header flags */
+#define CACHE_HAS_ENTRIES 1       /* The .ent file is created */
+#define CACHE_HAS_EXTERNALS 2     /* The .ext file is created */
+#define CACHE_HAS_EXPANDED 4      /* The .am file is kept */
+#define CACHE_HAS_RELOCATIONS 8   /* The .rel file is created */
+#define CACHE_HAS_LINE_MAP 16     /* The .map file is created */
+
+/*
+ * Restores the output files of a source from the cache.
+ *
+ * @param directory The cache directory.
+ * @param source The text of the source.
+ * @param length The number of characters in the source.
+ * @param options The options; objectFormat and the options adding files are part of the key.
+ * @param output Receives the object files, when the entry is found.
+ * @param expanded Receives the .am file when keepExpandedFile is set.
+ * @return CACHE_HIT, CACHE_MISS, or CACHE_INVALID when the entry exists but is stale or corrupted.
+ */
+int loadCacheEntry(const char *directory, const char *source, long length, const assemblerOptions *options,
+                   objectBuffers *output, byteBuffer *expanded);
+
+/*
+ * Stores the output files of a source in the cache, creating the directory if needed.
+ *
+ * The entry is written to a temporary file and renamed, so a reader never sees half
+ * an entry, even when several threads or processes share the directory.
+ *
+ * @param directory The cache directory.
+ * @param source The text of the source.
+ * @param length The number of characters in the source.
+ * @param options The options the files were produced with.
+ * @param output The object files.
+ * @param expanded The .am file, used when keepExpandedFile is set.
+ * @return true if the entry was stored, false otherwise.
+ */
+bool storeCacheEntry(const char *directory, const char *source, long length, const assemblerOptions *options,
+                     objectBuffers *output, byteBuffer *expanded);
+
+#endif
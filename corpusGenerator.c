@@ -0,0 +1,240 @@
+/*
+ * corpusGenerator.c
+ *
+ * Description:
+ * Generates a reproducible synthetic assembly program for benchmarking the assembler.
+ * The program mixes macros, labels, .data/.string, .extern/.entry directives and
+ * all 16 operations with every addressing mode they accept.
+ *
+ * Usage:
+ *   ./corpusGenerator <lines> <output file> [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LABEL_EVERY 4         /* Every fourth line of the body carries a label */
+#define MACROS 8              /* Number of macros defined at the top of the program */
+#define MACRO_LINES 3         /* Number of lines in each macro */
+#define MAX_EXTERNALS 64      /* Upper bound on the number of .extern symbols */
+#define MAX_DATA_VALUES 8     /* Upper bound on the values of one .data line */
+#define MAX_STRING_LENGTH 20  /* Upper bound on the length of one .string */
+#define DEFAULT_SEED 14
+
+/* Addressing modes, as bit masks of the modes an operand accepts */
+#define IMMEDIATE_MODE 1
+#define DIRECT_MODE 2
+#define INDIRECT_REG_MODE 4
+#define DIRECT_REG_MODE 8
+#define ALL_MODES (IMMEDIATE_MODE | DIRECT_MODE | INDIRECT_REG_MODE | DIRECT_REG_MODE)
+#define WRITABLE_MODES (DIRECT_MODE | INDIRECT_REG_MODE | DIRECT_REG_MODE)
+#define JUMP_MODES (DIRECT_MODE | INDIRECT_REG_MODE)
+
+/* Structure describing an operation and the addressing modes of its operands. */
+typedef struct {
+    const char *name;   /* The name of the operation */
+    int sourceModes;    /* Modes accepted by the source operand, 0 if there is none */
+    int destModes;      /* Modes accepted by the destination operand, 0 if there is none */
+} operationSpec;
+
+static const operationSpec operations[] = {
+    {"mov", ALL_MODES, WRITABLE_MODES},
+    {"cmp", ALL_MODES, ALL_MODES},
+    {"add", ALL_MODES, WRITABLE_MODES},
+    {"sub", ALL_MODES, WRITABLE_MODES},
+    {"lea", DIRECT_MODE, WRITABLE_MODES},
+    {"clr", 0, WRITABLE_MODES},
+    {"not", 0, WRITABLE_MODES},
+    {"inc", 0, WRITABLE_MODES},
+    {"dec", 0, WRITABLE_MODES},
+    {"jmp", 0, JUMP_MODES},
+    {"bne", 0, JUMP_MODES},
+    {"red", 0, WRITABLE_MODES},
+    {"prn", 0, ALL_MODES},
+    {"jsr", 0, JUMP_MODES},
+    {"rts", 0, 0},
+    {"stop", 0, 0}
+};
+
+/* State of the generator, kept together so the output only depends on the arguments. */
+typedef struct {
+    unsigned long state;  /* State of the random number generator */
+    long bodyLines;       /* Number of lines in the body of the program */
+    int externals;        /* Number of .extern symbols */
+} generator;
+
+/* Returns the next 32 bit pseudo random number (xorshift32). */
+static unsigned long nextRandom(generator *gen) {
+    unsigned long x = gen->state;
+    x ^= (x << 13) & 0xFFFFFFFFUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFUL;
+    gen->state = x;
+    return x;
+}
+
+/* Returns a pseudo random number in [0, bound). */
+static long randomBelow(generator *gen, long bound) {
+    return (long) (nextRandom(gen) % (unsigned long) bound);
+}
+
+/* Writes the name of a random label of the body. */
+static void writeLabelName(FILE *file, generator *gen) {
+    long labels = (gen->bodyLines + LABEL_EVERY - 1) / LABEL_EVERY;
+    fprintf(file, "L%ld", randomBelow(gen, labels) * LABEL_EVERY);
+}
+
+/* Writes an operand in one of the given addressing modes. */
+static void writeOperand(FILE *file, generator *gen, int modes) {
+    int mode;
+
+    /* Pick one of the accepted modes */
+    do {
+        mode = 1 << randomBelow(gen, 4);
+    } while (!(mode & modes));
+
+    if (mode == IMMEDIATE_MODE) {
+        fprintf(file, "#%ld", randomBelow(gen, 1001) - 500);
+    } else if (mode == DIRECT_MODE) {
+        if (gen->bodyLines == 0 || randomBelow(gen, 5) == 0) {
+            fprintf(file, "X%ld", randomBelow(gen, gen->externals));
+        } else {
+            writeLabelName(file, gen);
+        }
+    } else if (mode == INDIRECT_REG_MODE) {
+        fprintf(file, "*r%ld", randomBelow(gen, 8));
+    } else {
+        fprintf(file, "r%ld", randomBelow(gen, 8));
+    }
+}
+
+/* Writes a random instruction, without a label and without the line feed. */
+static void writeInstruction(FILE *file, generator *gen) {
+    const operationSpec *operation = &operations[randomBelow(gen, sizeof(operations) / sizeof(operations[0]))];
+
+    fprintf(file, " %s", operation->name);
+    if (operation->sourceModes) {
+        fprintf(file, " ");
+        writeOperand(file, gen, operation->sourceModes);
+        fprintf(file, ", ");
+        writeOperand(file, gen, operation->destModes);
+    } else if (operation->destModes) {
+        fprintf(file, " ");
+        writeOperand(file, gen, operation->destModes);
+    }
+}
+
+/* Writes a .data directive with a few random values. */
+static void writeData(FILE *file, generator *gen) {
+    long i, values = 1 + randomBelow(gen, MAX_DATA_VALUES);
+
+    fprintf(file, " .data %ld", randomBelow(gen, 2001) - 1000);
+    for (i = 1; i < values; i++) {
+        fprintf(file, ", %ld", randomBelow(gen, 2001) - 1000);
+    }
+}
+
+/* Writes a .string directive with a random alphabetic string. */
+static void writeString(FILE *file, generator *gen) {
+    long i, length = 1 + randomBelow(gen, MAX_STRING_LENGTH);
+
+    fprintf(file, " .string \"");
+    for (i = 0; i < length; i++) {
+        fputc((randomBelow(gen, 2) ? 'a' : 'A') + (int) randomBelow(gen, 26), file);
+    }
+    fprintf(file, "\"");
+}
+
+/* Writes the program: externals, macro definitions, the body and a final stop. */
+static void writeProgram(FILE *file, generator *gen, long lines) {
+    long i;
+    int m, k;
+
+    fprintf(file, "; synthetic corpus: %ld lines\n", lines);
+    for (i = 0; i < gen->externals; i++) {
+        fprintf(file, ".extern X%ld\n", i);
+    }
+
+    for (m = 0; m < MACROS; m++) {
+        fprintf(file, "macr m%d\n", m);
+        for (k = 0; k < MACRO_LINES; k++) {
+            writeInstruction(file, gen);
+            fprintf(file, "\n");
+        }
+        fprintf(file, "endmacr\n");
+    }
+
+    for (i = 0; i < gen->bodyLines; i++) {
+        long kind = randomBelow(gen, 100);
+
+        if (i % LABEL_EVERY == 0) {
+            /* Labeled line: an instruction, .data or .string */
+            fprintf(file, "L%ld:", i);
+            if (kind < 70) {
+                writeInstruction(file, gen);
+            } else if (kind < 90) {
+                writeData(file, gen);
+            } else {
+                writeString(file, gen);
+            }
+        } else if (kind < 70) {
+            writeInstruction(file, gen);
+        } else if (kind < 85) {
+            fprintf(file, " m%ld", randomBelow(gen, MACROS));
+        } else if (kind < 90) {
+            writeData(file, gen);
+        } else if (kind < 95) {
+            fprintf(file, ".entry ");
+            writeLabelName(file, gen);
+        } else {
+            fprintf(file, "; comment %ld", i);
+        }
+        fprintf(file, "\n");
+    }
+    fprintf(file, " stop\n");
+}
+
+/*
+ * Main function of the generator.
+ * @param argc The number of command-line arguments.
+ * @param argv The number of lines, the output file and an optional seed.
+ * @return 0 if successful, otherwise 1.
+ */
+int main(int argc, char *argv[]) {
+    generator gen;
+    long lines, header;
+    FILE *file;
+
+    if (argc < 3 || argc > 4) {
+        printf("Usage: %s <lines> <output file> [seed]\n", argv[0]);
+        return 1;
+    }
+
+    lines = atol(argv[1]);
+    if (lines < 1) {
+        printf("Invalid number of lines: %s\n", argv[1]);
+        return 1;
+    }
+
+    gen.state = argc == 4 ? strtoul(argv[3], NULL, 10) : DEFAULT_SEED;
+    if ((gen.state &= 0xFFFFFFFFUL) == 0) {
+        gen.state = DEFAULT_SEED;  /* xorshift needs a non zero state */
+    }
+
+    /* Split the lines between the header (comment, externals, macros), the body and the final stop */
+    gen.externals = (int) (lines / 1000 + 1);
+    if (gen.externals > MAX_EXTERNALS) {
+        gen.externals = MAX_EXTERNALS;
+    }
+    header = 1 + gen.externals + MACROS * (MACRO_LINES + 2);
+    gen.bodyLines = lines > header + 1 ? lines - header - 1 : 0;
+
+    file = fopen(argv[2], "w");
+    if (file == NULL) {
+        printf("Error creating output file: %s\n", argv[2]);
+        return 1;
+    }
+    writeProgram(file, &gen, lines);
+    fclose(file);
+    return 0;
+}
@@ -1,54 +1,49 @@
+
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "allocation.h"
 #include "memory.h"
 
-/* Initializes a data list with a single node. */
-dataList *initDataList() {
-    return allocateNewDNode(); /* Initialize with a single node */
-}
+/* Initializes an empty data segment. */
+dataSegment *initDataSegment() {
 
-/* Allocates and initializes a new node for the data list. */
-dataList *allocateNewDNode() {
+    /* Allocate memory for the segment and its words */
+    dataSegment *segment = allocateMemory(sizeof(dataSegment));
 
-    /* Allocate memory for new node */
-    dataList *newNode = malloc(sizeof(dataList));
-    if (newNode == NULL) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(EXIT_FAILURE);
-    }
+    segment->words = allocateMemory(INITIAL_SEGMENT_CAPACITY * sizeof(unsigned short));
 
-    /* Initialize the new node's fields */
-    newNode->count = 0;
-    newNode->line = 0;
-    newNode->next = NULL;
-    return newNode;
+    /* Initialize the segment's fields */
+    segment->count = 0;
+    segment->capacity = INITIAL_SEGMENT_CAPACITY;
+    return segment;
 }
 
-/* Adds a new node to the end of the data list. */
-void addToDataList(dataList **tail, int count, unsigned short line) {
-    /* Set the values of the current tail node */
-    (*tail)->count = count;
-    (*tail)->line = line;
-
-    /* Allocate the next node */
-    (*tail)->next = allocateNewDNode();
-
-    /* Move the tail to the next node */
-    *tail = (*tail)->next;
+/* Makes room for words at the end of the data segment and returns the first free word. */
+unsigned short *reserveDataSegment(dataSegment *segment, int count) {
+    int capacity = segment->capacity;
+
+    /* Double the segment until the words fit */
+    if (segment->count + count > capacity) {
+        while (segment->count + count > capacity) {
+            capacity *= 2;
+        }
+        segment->words = reallocateMemory(segment->words, capacity * sizeof(unsigned short));
+        segment->capacity = capacity;
+    }
+    return segment->words + segment->count;
 }
 
-/* Frees all nodes in the data list. */
-void freeDataList(dataList *head) {
-    dataList *current = head;  /* Pointer to traverse the list */
-    dataList *next;            /* Pointer to hold the next node */
+/* Removes every word from the data segment, keeping its memory. */
+void clearDataSegment(dataSegment *segment) {
+    segment->count = 0;
+}
 
-    while (current != NULL) {
-        next = current->next;  /* Save the next node */
-        free(current);         /* Free the memory of the current node */
-        current = next;        /* Move to the next node */
+/* Frees the data segment. */
+void freeDataSegment(dataSegment *segment) {
+    if (segment != NULL) {
+        free(segment->words);  /* Free the words */
+        free(segment);         /* Free the segment structure */
     }
-    head = NULL;               /* Set the head pointer to NULL after freeing the list */
 }
-
@@ -0,0 +1,67 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "allocation.h"
+#include "diagnostics.h"
+
+/* Initializes an empty list of errors and warnings. */
+void initDiagnostics(diagnosticList *diagnostics) {
+    diagnostics->items = NULL;
+    diagnostics->count = 0;
+    diagnostics->errors = 0;
+    diagnostics->capacity = 0;
+    diagnostics->line = 0;
+}
+
+/* Appends a message on the current line of the list. */
+static void addDiagnostic(diagnosticList *diagnostics, bool warning, const char *format, va_list arguments) {
+    diagnostic *message;
+
+    /* Grow the list geometrically */
+    if (diagnostics->count == diagnostics->capacity) {
+        int capacity = diagnostics->capacity ? 2 * diagnostics->capacity : INITIAL_DIAGNOSTICS;
+        diagnostics->items = reallocateMemory(diagnostics->items, capacity * sizeof(diagnostic));
+        diagnostics->capacity = capacity;
+    }
+
+    message = &diagnostics->items[diagnostics->count++];
+    message->line = diagnostics->line;
+    message->warning = warning;
+    vsnprintf(message->message, MAX_DIAGNOSTIC_LENGTH, format, arguments);
+}
+
+/* Reports an error on the current line of the list. */
+void reportError(diagnosticList *diagnostics, const char *format, ...) {
+    va_list arguments;
+
+    va_start(arguments, format);
+    addDiagnostic(diagnostics, false, format, arguments);
+    va_end(arguments);
+    diagnostics->errors++;
+}
+
+/* Reports a warning on the current line of the list. */
+void reportWarning(diagnosticList *diagnostics, const char *format, ...) {
+    va_list arguments;
+
+    va_start(arguments, format);
+    addDiagnostic(diagnostics, true, format, arguments);
+    va_end(arguments);
+}
+
+/* Writes the messages of the list, one per line. */
+void printDiagnostics(FILE *file, diagnosticList *diagnostics) {
+    int i;
+    for (i = 0; i < diagnostics->count; i++) {
+        fprintf(file, "%s\n", diagnostics->items[i].message);
+    }
+}
+
+/* Frees the messages of a list and leaves it empty. */
+void freeDiagnostics(diagnosticList *diagnostics) {
+    free(diagnostics->items);
+    initDiagnostics(diagnostics);
+}
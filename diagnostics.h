@@ -0,0 +1,69 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdio.h>
+
+#include "header.h"
+
+#define MAX_DIAGNOSTIC_LENGTH 200
+#define INITIAL_DIAGNOSTICS 16
+
+/* Structure representing an error or a warning found in a source file. */
+typedef struct {
+    int line;                             /* Number of the source line, 0 when not tied to a line */
+    bool warning;                         /* A warning is printed, but the source still assembles */
+    char message[MAX_DIAGNOSTIC_LENGTH];  /* The message, without a line feed */
+} diagnostic;
+
+/* Structure collecting the errors and the warnings of a source file, in the order they were found. */
+typedef struct {
+    diagnostic *items;        /* The errors and the warnings */
+    int count;                /* Number of errors and warnings */
+    int errors;               /* Number of errors */
+    int capacity;             /* Number of messages the array can hold */
+    int line;                 /* The source line being processed, stamped on new messages */
+} diagnosticList;
+
+/*
+ * Initializes an empty list of errors and warnings.
+ *
+ * @param diagnostics The list to initialize.
+ */
+void initDiagnostics(diagnosticList *diagnostics);
+
+/*
+ * Reports an error on the current line of the list.
+ *
+ * The message is formatted like printf and cut to MAX_DIAGNOSTIC_LENGTH characters.
+ *
+ * @param diagnostics The list receiving the error.
+ * @param format The format of the message.
+ */
+void reportError(diagnosticList *diagnostics, const char *format, ...);
+
+/*
+ * Reports a warning on the current line of the list.
+ *
+ * A warning is written with the errors, but it is not counted as one.
+ *
+ * @param diagnostics The list receiving the warning.
+ * @param format The format of the message, like printf.
+ */
+void reportWarning(diagnosticList *diagnostics, const char *format, ...);
+
+/*
+ * Writes the messages of the list, one per line.
+ *
+ * @param file The stream to write to.
+ * @param diagnostics The errors and the warnings to write.
+ */
+void printDiagnostics(FILE *file, diagnosticList *diagnostics);
+
+/*
+ * Frees the messages of a list and leaves it empty.
+ *
+ * @param diagnostics The list to free.
+ */
+void freeDiagnostics(diagnosticList *diagnostics);
+
+#endif
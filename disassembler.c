@@ -0,0 +1,668 @@
+/*
+ * disassembler.c
+ *
+ * Description:
+ * Turns assembled programs back into sources that assemble to the very same
+ * object files. A first word has 15 bits, so every value it can take is
+ * decoded once, into a table of DECODE_ENTRIES entries giving the operation,
+ * the addressing modes and the number of words of the instruction; decoding
+ * the program is then one lookup per instruction.
+ *
+ * The entries of the .ent file name their labels, and the references of the
+ * .ext file name the external words. Every other address a relocatable word
+ * refers to gets a label L followed by its address. The data follows the
+ * code, except where the order of the .ent file needs a data label defined
+ * earlier; runs of letters ending with a zero word become .string lines.
+ *
+ * With --verify nothing is printed: each program is assembled again in memory
+ * and its files are compared with those it was read from, and the number of
+ * words checked per second is reported.
+ *
+ * Usage:
+ *   ./disasm prog.ob                   prints the source of prog
+ *   ./disasm --verify *.ob *.bin       checks that every program disassembles losslessly
+ * A program is read from its .ob, .ent and .ext files, or from its binary
+ * object file when its name ends with .bin.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "assembler.h"
+#include "keywords.h"
+#include "libassembler.h"
+#include "machineCode.h"
+#include "objectFile.h"
+#include "outputFiles.h"
+#include "statistics.h"
+#include "stringPool.h"
+
+#define DECODE_ENTRIES 32768      /* Values of a 15 bit word */
+#define WORD_MASK 0x7FFF          /* The 15 bits of a word */
+#define SIGN_BIT 0x4000           /* The sign of a 15 bit word */
+#define IMMEDIATE_SIGN 0x800      /* The sign of a 12 bit immediate value */
+#define REGISTER_MASK 7           /* The bits of a register number in an operand word */
+#define MODE_MASK 0xF             /* The four addressing mode bits of an operand */
+#define OPERATION_MASK 0xF        /* The four opcode bits of an instruction */
+#define LINE_WIDTH 72             /* Longest .data or .string line written, below MAX_LINE_LENGTH */
+
+/* Structure representing the decoding of a first word. */
+typedef struct {
+    signed char operation;    /* The opcode */
+    signed char sourceMode;   /* Addressing mode of the source operand, -1 if there is none */
+    signed char targetMode;   /* Addressing mode of the destination operand, -1 if there is none */
+    signed char length;       /* Number of words of the instruction, 0 if the word is not an instruction */
+} decodedWord;
+
+/* Structure representing a program being disassembled. Words are numbered code first, then data. */
+typedef struct {
+    objectModule module;      /* The program */
+    int words;                /* Number of code and data words */
+    int *labels;              /* Name ID of the label defined at each word, NO_STRING for none */
+    int *operands;            /* Name ID a direct operand word refers to, NO_STRING for none */
+    int *lengths;             /* Number of words of the instruction starting at each code word, 0 elsewhere */
+    int *references;          /* Name ID of the label each value of a relocatable word refers to */
+    stringPool *names;        /* The names of the labels and of the external symbols */
+    stringPool *externs;      /* The names of the external symbols, in the order of their first reference */
+    const char *error;        /* Why the program cannot be disassembled, NULL if it can */
+    int errorAddress;         /* The address the error is about */
+} disassembly;
+
+/* The first word decoding of every 15 bit value */
+static decodedWord decodeTable[DECODE_ENTRIES];
+
+static const char *const operationNames[OPERATIONS] = {
+    "mov", "cmp", "add", "sub", "lea", "clr", "not", "inc",
+    "dec", "jmp", "bne", "red", "prn", "jsr", "rts", "stop"
+};
+
+/* Returns the addressing mode of the one-hot mode bits of an operand, -1 for none and -2 for a bad value. */
+static int decodeMode(int bits) {
+    switch (bits) {
+        case 0: return -1;
+        case 1: return IMMEDIATE;
+        case 2: return DIRECT;
+        case 4: return INDIRECT_REG;
+        case 8: return DIRECT_REG;
+        default: return -2;
+    }
+}
+
+/* Decodes every value a first word can take, the way encodeInstructions encodes them. */
+static void buildDecodeTable(void) {
+    int word, operation, sourceMode, targetMode, operands;
+    decodedWord *entry;
+
+    for (word = 0; word < DECODE_ENTRIES; word++) {
+        entry = &decodeTable[word];
+        operation = (word >> OP_C_POSITION) & OPERATION_MASK;
+        sourceMode = decodeMode((word >> S_POSITION) & MODE_MASK);
+        targetMode = decodeMode((word >> D_POSITION) & MODE_MASK);
+        operands = (sourceMode >= 0) + (targetMode >= 0);
+
+        entry->operation = (signed char) operation;
+        entry->sourceMode = (signed char) sourceMode;
+        entry->targetMode = (signed char) targetMode;
+        entry->length = 0;
+
+        /* A single operand is a destination */
+        if ((word & ARE_MASK) != (1 << A_BIT) || sourceMode == -2 || targetMode == -2 ||
+            operands != operandsOfOperation(operation) || (operands == 1 && sourceMode >= 0)) {
+            continue;
+        }
+        entry->length = (signed char) (1 + operands);
+        if (operands == 2 && sourceMode >= INDIRECT_REG && targetMode >= INDIRECT_REG) {
+            entry->length = 2;
+        }
+    }
+}
+
+/* Records the first error found in a program. */
+static void disassemblyError(disassembly *program, const char *error, int address) {
+    if (program->error == NULL) {
+        program->error = error;
+        program->errorAddress = address;
+    }
+}
+
+/* Returns the address of a word. */
+static int wordAddress(disassembly *program, int index) {
+    objectModule *module = &program->module;
+    return index < module->codeCount ? module->loadBase + index : module->dataBase + index - module->codeCount;
+}
+
+/* Returns the word at an address, or -1 if the address is outside the program. */
+static int wordIndex(disassembly *program, int address) {
+    objectModule *module = &program->module;
+
+    if (address >= module->loadBase && address < module->loadBase + module->codeCount) {
+        return address - module->loadBase;
+    }
+    if (address >= module->dataBase && address < module->dataBase + module->dataCount) {
+        return module->codeCount + address - module->dataBase;
+    }
+    return -1;
+}
+
+/* Returns whether a label can be defined at a word: a data word or the first word of an instruction. */
+static bool labelable(disassembly *program, int index) {
+    return index >= program->module.codeCount || program->lengths[index] > 0;
+}
+
+/* Checks that an operand word holds exactly what the assembler writes for its mode. */
+static bool validOperandWord(unsigned short word, int mode, int registerPosition) {
+    switch (mode) {
+        case IMMEDIATE:
+            return (word & ARE_MASK) == (1 << A_BIT);
+        case DIRECT:
+            return (word & ARE_MASK) == (1 << R_BIT) || word == (1 << E_BIT);
+        default:
+            return (word & ~(REGISTER_MASK << registerPosition)) == (1 << A_BIT);
+    }
+}
+
+/* Splits the code into instructions through the decode table, and checks their operand words. */
+static void decodeCode(disassembly *program) {
+    objectModule *module = &program->module;
+    const decodedWord *entry;
+    unsigned short *code = module->code;
+    int i = 0, length;
+    bool valid;
+
+    while (i < module->codeCount) {
+        entry = &decodeTable[code[i] & WORD_MASK];
+        length = entry->length;
+        if (code[i] > WORD_MASK || length == 0 || i + length > module->codeCount) {
+            disassemblyError(program, "Word is not an instruction", module->loadBase + i);
+            return;
+        }
+
+        if (length == 2 && entry->sourceMode >= 0) {
+            valid = (code[i + 1] & ~(REGISTER_MASK << S_REG_POSITION | REGISTER_MASK << D_REG_POSITION)) ==
+                    (1 << A_BIT);
+        } else if (length == 3) {
+            valid = validOperandWord(code[i + 1], entry->sourceMode, S_REG_POSITION) &&
+                    validOperandWord(code[i + 2], entry->targetMode, D_REG_POSITION);
+        } else {
+            valid = length == 1 || validOperandWord(code[i + 1], entry->targetMode, D_REG_POSITION);
+        }
+        if (!valid) {
+            disassemblyError(program, "Invalid operand word", module->loadBase + i);
+            return;
+        }
+
+        program->lengths[i] = length;
+        i += length;
+    }
+}
+
+/* Interns a name, returning NO_STRING if it was interned before. */
+static int internNewName(disassembly *program, const char *name) {
+    span s;
+    int known = program->names->count, id;
+
+    s.start = name;
+    s.length = (int) strlen(name);
+    id = internString(program->names, s);
+    return id == known ? id : NO_STRING;
+}
+
+/* Names the entries and the external references. */
+static void nameSymbols(disassembly *program) {
+    objectModule *module = &program->module;
+    objectSymbol *symbol;
+    span name;
+    int i, index;
+
+    for (i = 0; i < module->entryCount; i++) {
+        symbol = &module->entries[i];
+        index = wordIndex(program, symbol->address);
+        if (index < 0 || !labelable(program, index) || program->labels[index] != NO_STRING) {
+            disassemblyError(program, "Entry cannot be defined at its address", symbol->address);
+            return;
+        }
+        program->labels[index] = internNewName(program, symbol->name);
+        if (program->labels[index] == NO_STRING) {
+            disassemblyError(program, "Entry defined twice", symbol->address);
+            return;
+        }
+    }
+
+    for (i = 0; i < module->externCount; i++) {
+        symbol = &module->externs[i];
+        index = symbol->address - module->loadBase;
+        if (index < 0 || index >= module->codeCount || module->code[index] != (1 << E_BIT)) {
+            disassemblyError(program, "External reference to a word that is not external", symbol->address);
+            return;
+        }
+        name.start = symbol->name;
+        name.length = (int) strlen(symbol->name);
+        program->operands[index] = internString(program->names, name);
+        internString(program->externs, name);
+    }
+}
+
+/*
+ * Returns the label of the address a relocatable word holds, defining one if needed.
+ *
+ * The word only holds the low 13 bits of the address. Any word of the program with the
+ * same low bits encodes the same, so a word that has a label already is preferred, and
+ * the label found is kept for the other words holding the same value.
+ */
+static int referencedLabel(disassembly *program, unsigned short word) {
+    char name[MAX_LABEL_LENGTH];
+    int value = word >> VAL_POSITION, address, first = -1, index, length;
+    objectModule *module = &program->module;
+    int end = module->dataBase + module->dataCount;
+
+    if (program->references[value] != NO_STRING) {
+        return program->references[value];
+    }
+    for (address = value; address < end; address += LABEL_ADDRESS_SPAN) {
+        index = wordIndex(program, address);
+        if (index >= 0 && labelable(program, index)) {
+            if (program->labels[index] != NO_STRING) {
+                return program->references[value] = program->labels[index];
+            }
+            if (first < 0) {
+                first = index;
+            }
+        }
+    }
+    if (first < 0) {
+        return NO_STRING;
+    }
+
+    /* L and the address, made longer while it is the name of another symbol */
+    length = sprintf(name, "L%04d", wordAddress(program, first));
+    while ((program->labels[first] = internNewName(program, name)) == NO_STRING && length < MAX_LABEL_LENGTH - 1) {
+        name[length++] = 'x';
+        name[length] = '\0';
+    }
+    return program->references[value] = program->labels[first];
+}
+
+/* Labels every address the relocatable words refer to. */
+static void labelReferences(disassembly *program) {
+    objectModule *module = &program->module;
+    int i;
+
+    for (i = 0; i < module->codeCount; i++) {
+        if (program->lengths[i] == 0 && (module->code[i] & ARE_MASK) == (1 << R_BIT)) {
+            program->operands[i] = referencedLabel(program, module->code[i]);
+            if (program->operands[i] == NO_STRING) {
+                disassemblyError(program, "Reference to an address no label can be defined at", module->loadBase + i);
+                return;
+            }
+        } else if (program->lengths[i] == 0 && module->code[i] == (1 << E_BIT) && program->operands[i] == NO_STRING) {
+            disassemblyError(program, "External word without a reference in the .ext file", module->loadBase + i);
+            return;
+        }
+    }
+}
+
+/* Appends text to a buffer. */
+static void appendText(byteBuffer *out, const char *text, int length) {
+    memcpy(extendByteBuffer(out, length), text, length);
+}
+
+/* Appends a name of the pool to a buffer. */
+static void appendName(byteBuffer *out, disassembly *program, int id) {
+    appendText(out, poolString(program->names, id), poolStringLength(program->names, id));
+}
+
+/* Appends a signed decimal number to a buffer. */
+static void appendNumber(byteBuffer *out, long value) {
+    char digits[24];
+    appendText(out, digits, sprintf(digits, "%ld", value));
+}
+
+/* Starts a line, with the label defined at a word. */
+static void startLine(byteBuffer *out, disassembly *program, int index) {
+    if (program->labels[index] != NO_STRING) {
+        appendName(out, program, program->labels[index]);
+        appendText(out, ":", 1);
+    }
+    appendText(out, "\t", 1);
+}
+
+/* Appends an operand of an instruction. */
+static void appendOperand(byteBuffer *out, disassembly *program, int index, int mode, int registerPosition) {
+    unsigned short word = program->module.code[index];
+    long value;
+
+    switch (mode) {
+        case IMMEDIATE:
+            value = (word >> VAL_POSITION) & ADDRESS_MASK;
+            appendText(out, "#", 1);
+            appendNumber(out, value & IMMEDIATE_SIGN ? value - (ADDRESS_MASK + 1) : value);
+            break;
+        case DIRECT:
+            appendName(out, program, program->operands[index]);
+            break;
+        case INDIRECT_REG:
+            appendText(out, "*", 1);
+            /* fall through */
+        default:
+            appendText(out, "r", 1);
+            appendNumber(out, (word >> registerPosition) & REGISTER_MASK);
+            break;
+    }
+}
+
+/* Appends the instruction starting at a code word, and returns the word after it. */
+static int appendInstruction(byteBuffer *out, disassembly *program, int index) {
+    const decodedWord *entry = &decodeTable[program->module.code[index]];
+    int length = program->lengths[index];
+
+    startLine(out, program, index);
+    appendText(out, operationNames[(int) entry->operation], (int) strlen(operationNames[(int) entry->operation]));
+
+    if (entry->sourceMode >= 0) {
+        appendText(out, " ", 1);
+        appendOperand(out, program, index + 1, entry->sourceMode, S_REG_POSITION);
+        appendText(out, ", ", 2);
+        appendOperand(out, program, index + length - 1, entry->targetMode, D_REG_POSITION);
+    } else if (entry->targetMode >= 0) {
+        appendText(out, " ", 1);
+        appendOperand(out, program, index + 1, entry->targetMode, D_REG_POSITION);
+    }
+    appendText(out, "\n", 1);
+    return index + length;
+}
+
+/* Returns the value of a data word, numbered after the code words. */
+#define DATA_WORD(program, index) ((program)->module.data[(index) - (program)->module.codeCount])
+
+/* Returns the data word after a run of letters ending with a zero word and fitting on a line, or 0 if there is none. */
+static int stringEnd(disassembly *program, int index, int last, int room) {
+    int i = index;
+
+    while (i < last && i - index < room && DATA_WORD(program, i) < 128 && isalpha(DATA_WORD(program, i)) &&
+           (i == index || program->labels[i] == NO_STRING)) {
+        i++;
+    }
+    return i > index && i < last && DATA_WORD(program, i) == 0 && program->labels[i] == NO_STRING ? i + 1 : 0;
+}
+
+/* Appends one .data or .string line starting at a data word, up to a word, and returns the word after it. */
+static int appendDataLine(byteBuffer *out, disassembly *program, int index, int last) {
+    long start = out->length, value;
+    int i = index, end;
+    char letter;
+
+    startLine(out, program, index);
+    end = stringEnd(program, index, last, LINE_WIDTH - (int) (out->length - start) - 10);
+    if (end > 0) {
+        appendText(out, ".string \"", 9);
+        for (; i < end - 1; i++) {
+            letter = (char) DATA_WORD(program, i);
+            appendText(out, &letter, 1);
+        }
+        appendText(out, "\"\n", 2);
+        return end;
+    }
+
+    /* Values until the next label, as many as fit on the line */
+    appendText(out, ".data ", 6);
+    do {
+        if (i > index) {
+            appendText(out, ", ", 2);
+        }
+        value = DATA_WORD(program, i) & WORD_MASK;
+        appendNumber(out, value & SIGN_BIT ? value - (WORD_MASK + 1) : value);
+        i++;
+    } while (i < last && program->labels[i] == NO_STRING && out->length - start < LINE_WIDTH - 10);
+    appendText(out, "\n", 1);
+    return i;
+}
+
+/*
+ * Writes the source of a program.
+ *
+ * The entries are listed in the order labels are defined, so the code and the data are
+ * written in turns as far as the next entry of the .ent file.
+ */
+static void writeSource(byteBuffer *out, disassembly *program) {
+    objectModule *module = &program->module;
+    int code = 0, data = module->codeCount, i, index;
+    char name[MAX_LABEL_LENGTH];
+
+    for (i = 0; i < module->entryCount; i++) {
+        appendText(out, ".entry ", 7);
+        appendText(out, module->entries[i].name, (int) strlen(module->entries[i].name));
+        appendText(out, "\n", 1);
+    }
+    for (i = 0; i < program->externs->count; i++) {
+        appendText(out, ".extern ", 8);
+        appendText(out, poolString(program->externs, i), poolStringLength(program->externs, i));
+        appendText(out, "\n", 1);
+    }
+
+    /* An .ext file without references still needs an external symbol declared */
+    if (module->hasExternals && program->externs->count == 0) {
+        strcpy(name, "UNUSED");
+        while (internNewName(program, name) == NO_STRING && strlen(name) < MAX_LABEL_LENGTH - 1) {
+            strcat(name, "x");
+        }
+        appendText(out, ".extern ", 8);
+        appendText(out, name, (int) strlen(name));
+        appendText(out, "\n", 1);
+    }
+
+    for (i = 0; i < module->entryCount; i++) {
+        index = wordIndex(program, module->entries[i].address);
+        if (index < module->codeCount) {
+            while (code <= index) {
+                code = appendInstruction(out, program, code);
+            }
+        } else {
+            while (data < index) {
+                data = appendDataLine(out, program, data, index);
+            }
+            if (data == index) {
+                data = appendDataLine(out, program, data, program->words);
+            }
+        }
+    }
+    while (code < module->codeCount) {
+        code = appendInstruction(out, program, code);
+    }
+    while (data < program->words) {
+        data = appendDataLine(out, program, data, program->words);
+    }
+}
+
+/*
+ * Disassembles a program.
+ * @param fileName The object file of the program.
+ * @param out Receives the source.
+ * @param program Receives the program; freed with freeDisassembly, even when this fails.
+ * @return true if the source was written, false otherwise.
+ */
+static bool disassemble(const char *fileName, byteBuffer *out, disassembly *program) {
+    int i;
+
+    program->names = initStringPool();
+    program->externs = initStringPool();
+    program->labels = program->operands = program->lengths = program->references = NULL;
+    program->error = NULL;
+    if (!readObjectModule(fileName, &program->module)) {
+        initObjectModule(&program->module);
+        fprintf(stderr, "Error reading program: %s\n", fileName);
+        return false;
+    }
+
+    program->words = program->module.codeCount + program->module.dataCount;
+    program->labels = allocateMemory((program->words + 1) * sizeof(int));
+    program->operands = allocateMemory((program->words + 1) * sizeof(int));
+    program->lengths = allocateMemory((program->words + 1) * sizeof(int));
+    program->references = allocateMemory(LABEL_ADDRESS_SPAN * sizeof(int));
+    for (i = 0; i < program->words; i++) {
+        program->labels[i] = program->operands[i] = NO_STRING;
+        program->lengths[i] = 0;
+    }
+    for (i = 0; i < LABEL_ADDRESS_SPAN; i++) {
+        program->references[i] = NO_STRING;
+    }
+
+    decodeCode(program);
+    if (program->error == NULL) {
+        nameSymbols(program);
+    }
+    if (program->error == NULL) {
+        labelReferences(program);
+    }
+    if (program->error != NULL) {
+        fprintf(stderr, "%s: Error at address %04d: %s\n", fileName, program->errorAddress, program->error);
+        return false;
+    }
+
+    writeSource(out, program);
+    return true;
+}
+
+/* Frees a disassembled program. */
+static void freeDisassembly(disassembly *program) {
+    freeObjectModule(&program->module);
+    freeStringPool(program->names);
+    freeStringPool(program->externs);
+    free(program->labels);
+    free(program->operands);
+    free(program->lengths);
+    free(program->references);
+}
+
+/* Returns the line of the first difference between two files, 0 if they are equal. */
+static int differingLine(byteBuffer *expected, byteBuffer *actual) {
+    long i, shorter = expected->length < actual->length ? expected->length : actual->length;
+    int line = 1;
+
+    for (i = 0; i < shorter && expected->data[i] == actual->data[i]; i++) {
+        line += expected->data[i] == '\n';
+    }
+    return i == expected->length && i == actual->length ? 0 : line;
+}
+
+/*
+ * Assembles a disassembled source and compares its files with those of the program.
+ * @param fileName The object file of the program.
+ * @param program The program.
+ * @param source Its source.
+ * @param context The assembler context.
+ * @param expected A buffer for the files of the program.
+ * @return true if the files are the same, false otherwise.
+ */
+static bool verifySource(const char *fileName, disassembly *program, byteBuffer *source,
+                         assemblerContext *context, objectBuffers *expected) {
+    static const char *const extensions[3] = {".ob", ".ent", ".ext"};
+    assemblerOptions options;
+    assemblyResult *result;
+    byteBuffer *files[3], *actual[3];
+    int i, line;
+
+    memset(&options, 0, sizeof(options));
+    options.objectFormat = FORMAT_TEXT;
+    result = assembleBuffer(context, source->data, source->length, &options);
+    if (result->status != ASSEMBLY_SUCCESS) {
+        fprintf(stderr, "%s: The disassembled source does not assemble\n", fileName);
+        printDiagnostics(stderr, &result->diagnostics);
+        return false;
+    }
+
+    formatObjectBuffers(&program->module, &options, expected);
+    files[0] = &expected->object;
+    files[1] = &expected->entries;
+    files[2] = &expected->externals;
+    actual[0] = &result->output.object;
+    actual[1] = &result->output.entries;
+    actual[2] = &result->output.externals;
+    if (expected->hasEntries != result->output.hasEntries || expected->hasExternals != result->output.hasExternals) {
+        fprintf(stderr, "%s: The disassembled source does not create the same files\n", fileName);
+        return false;
+    }
+    for (i = 0; i < 3; i++) {
+        line = differingLine(files[i], actual[i]);
+        if (line > 0) {
+            fprintf(stderr, "%s: The %s file of the disassembled source differs at line %d\n", fileName,
+                    extensions[i], line);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Main function of the disassembler.
+ * @param argc The number of command-line arguments.
+ * @param argv The options and the programs to disassemble.
+ * @return 0 if every program was disassembled (and verified), otherwise 1.
+ */
+int main(int argc, char *argv[]) {
+    assemblerContext *context = NULL;
+    disassembly program;
+    objectBuffers expected;
+    byteBuffer source;
+    bool verify = false, success;
+    int first = 1, i, failures = 0;
+    long words = 0;
+    double start, seconds;
+
+    /* Parse the options given before the file names */
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "--verify") == 0) {
+            verify = true;
+        } else {
+            printf("Unknown option: %s\n", argv[first]);
+            return 1;
+        }
+        first++;
+    }
+
+    if (argc - first < 1) {
+        printf("Usage: %s [--verify] <file.ob> [<file 2> ...]\n", argv[0]);
+        return 1;
+    }
+
+    buildDecodeTable();
+    initByteBuffer(&source);
+    initObjectBuffers(&expected);
+    if (verify) {
+        context = initAssemblerContext();
+        if (context == NULL) {
+            fprintf(stderr, "Error: Not enough memory\n");
+            return 1;
+        }
+    }
+
+    start = currentTime();
+    for (i = first; i < argc; i++) {
+        source.length = 0;
+        success = disassemble(argv[i], &source, &program);
+        if (success && verify) {
+            success = verifySource(argv[i], &program, &source, context, &expected);
+            words += program.words;
+        } else if (success) {
+            if (argc - first > 1) {
+                printf("; %s\n", argv[i]);
+            }
+            fwrite(source.data, 1, source.length, stdout);
+        }
+        failures += !success;
+        freeDisassembly(&program);
+    }
+
+    if (verify) {
+        seconds = currentTime() - start;
+        fprintf(stderr, "Verified %d programs, %ld words in %.3f seconds (%.1f million words per second)",
+                argc - first - failures, words, seconds, seconds > 0 ? words / seconds / 1e6 : 0.0);
+        fprintf(stderr, failures > 0 ? ", %d failed\n" : "\n", failures);
+        freeAssemblerContext(context);
+    }
+    freeObjectBuffers(&expected);
+    freeByteBuffer(&source);
+    return failures > 0 ? 1 : 0;
+}
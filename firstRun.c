@@ -4,261 +4,238 @@
 #include <stdlib.h>
 #include <string.h>
 #include "firstRun.h"
+#include "header.h"
+#include "keywords.h"
 #include "processorUtils.h"
 #include "machineCode.h"
 
 
-int errors = 0;
+/* Parses the symbols of an external directive and adds them to the symbol table. */
+void handleExternalLine(span symbols, symbolTable *symTable) {
+    span token;
 
- /* Updates the addresses of data symbols in the symbol table by adding the instruction counter (IC). */
-void updateSymbolAddress(int IC, symbolTable *symTable) {
-    int i;
-    for (i = 0; i < symTable->count; i++) {
-        if (strcmp(symTable->symbols[i]->type, "data") == 0) {
-            symTable->symbols[i]->address += IC;
-        }
+    while (nextWord(&symbols, &token)) {
+        addSymbol(symTable, internName(symTable, token), SEGMENT_NONE, SYMBOL_EXTERNAL, 0);
     }
 }
 
-/* Parses a line with external symbols and adds them to the symbol table. */
-void handleExternalLine(char *line, symbolTable *symTable) {
-    char *token;
-    ignoreLeftWhiteSpaces(line);
-    removeDirectiveFromLine(line);
+/* Records the symbols of an entry directive, they are marked once all symbols are known. */
+void handleEntryLine(span symbols, symbolTable *symTable, fixupList *fixups) {
+    span token;
 
-    token = strtok(line, " \t\n");
-    while (token) {
-        addSymbol(symTable, token, "external", 0);
-        token = strtok(NULL, " \t\n");
+    while (nextWord(&symbols, &token)) {
+        addEntryFixup(fixups, internName(symTable, token));
     }
 }
 
-/* Parses valid values from a data line and stores them in an array. */
-void parseDataArray(char *line, unsigned short **content, int *dataCount) {
-    int commas;
-    char *token, *whitespace;
-
-    commas = expectedCommas(line);
-    token = strtok(line, ",");
-    *content = (unsigned short *) malloc(sizeof(unsigned short) * (commas + 1));
-
-    /* Validate successful allocating memory for data array */
-    if (*content != NULL) {
-        while (token) {
-            /* Remove leading whitespace from the token */
-            ignoreLeftWhiteSpaces(token);
-
-            whitespace = token; /* Check for trailing whitespace */
-            while (*whitespace) {
-                if(isspace(*whitespace) ) {break; }
-                whitespace++;
-            }
+/*
+ * Parses the values of a data line straight into the data segment, and returns their number.
+ * The line is read once: each field is skipped to its word, and a word that is an optional sign
+ * followed by digits is converted as it is read.
+ */
+int parseDataArray(span line, dataSegment *data, diagnosticList *diagnostics) {
+    const char *p = line.start, *end = line.start + line.length;
+    int fields = expectedCommas(line) + 1, count = 0, field;
+    unsigned short *words;
+    unsigned value;
+    bool negative, numeric;
+
+    /* Every field may hold a value, the words past the count are not part of the segment */
+    words = reserveDataSegment(data, fields);
+
+    for (field = 0; field < fields; field++, p++) {
+        /* Skip leading whitespace */
+        while (p < end && isspace((unsigned char) *p)) {
+            p++;
+        }
 
-            if (*whitespace) {
-                if (!isEmptyLine(whitespace)) {
-                    fprintf(stderr, "Error - Comma expected\n");
-                    errors++;
-                    return;
-                }
-            }
+        /* A word that is only a sign is the number 0, the way atoi reads it */
+        numeric = p < end && *p != ',';
+        negative = numeric && *p == '-';
+        if (numeric && (*p == '+' || *p == '-')) {
+            p++;
+        }
+
+        /* Only the low bits are kept, so the value is taken modulo the word and cannot overflow */
+        for (value = 0; p < end && isdigit((unsigned char) *p); p++) {
+            value = value * 10 + (unsigned) (*p - '0');
+        }
 
-            /* Convert token to numeric and store it */
-            if (isNumeric(token)) {
-                (*content)[*dataCount] = atoi(token);
-                (*dataCount)++;
+        /* Any other character makes the word other than a number */
+        if (p < end && *p != ',' && !isspace((unsigned char) *p)) {
+            numeric = false;
+            while (p < end && *p != ',' && !isspace((unsigned char) *p)) {
+                p++;
             }
-            token = strtok(NULL, ",");
         }
 
-        /* Validate the number of data items */
-        if (commas + 1 != *dataCount) {
-            errors++;
-            fprintf(stderr, "Error - invalid data format\n");
+        /* Check for anything after trailing whitespace */
+        while (p < end && isspace((unsigned char) *p)) {
+            p++;
+        }
+        if (p < end && *p != ',') {
+            reportError(diagnostics, "Error - Comma expected");
+            data->count += count;
+            return count;
         }
-        return;
+
+        /* Store the value as a 15-bit word */
+        if (numeric) {
+            words[count++] = word15bits((unsigned short) (negative ? 0U - value : value));
+        }
+    }
+
+    /* Validate the number of data items */
+    if (count != fields) {
+        reportError(diagnostics, "Error - invalid data format");
     }
-    errors++;
-    fprintf(stderr, "Memory allocation failed\n");
+    data->count += count;
+    return count;
 }
 
-/* Parses a string line and stores characters in an array. */
-void parseStringArray(char *line, unsigned short **content, int *dataCount) {
+/* Parses a string line straight into the data segment, and returns the number of words. */
+int parseStringArray(span line, dataSegment *data, diagnosticList *diagnostics) {
     int length, i;
-    char *startQuote, *endQuote;
+    const char *startQuote, *endQuote;
+    unsigned short *words;
 
     /* Remove leading whitespace from the line */
-    ignoreLeftWhiteSpaces(line);
+    line = trimLeft(line);
 
     /* Find the starting and ending quote of the string */
-    startQuote = strchr(line, '"');
-    endQuote = strrchr(line, '"');
+    startQuote = memchr(line.start, '"', line.length);
+    endQuote = line.start + line.length - 1;
+    while (endQuote >= line.start && *endQuote != '"') {
+        endQuote--;
+    }
 
     /* Validate string format */
-    if (startQuote == NULL || endQuote == NULL || startQuote == endQuote) {
-        errors++;
-        fprintf(stderr, "Error - Invalid string format\n");
-        return;
+    if (startQuote == NULL || endQuote < line.start || startQuote == endQuote) {
+        reportError(diagnostics, "Error - Invalid string format");
+        return 0;
     }
 
+    /* The characters are only added to the segment once they are all valid */
     length = endQuote - startQuote - 1;
-    *content = (unsigned short *) malloc((length + 1) * sizeof(unsigned short));
-    /* Validate allocating memory for string content */
-    if (*content == NULL) {
-        errors++;
-        fprintf(stderr, "Error - Memory allocation failed\n");
-        return;
-    }
+    words = reserveDataSegment(data, length + 1);
 
     for (i = 0; i < length; i++) {
-        /* Ensure each character is alphabetic */
-        if (!isalpha(startQuote[i + 1])) {
-            errors++;
-            fprintf(stderr, "Error - Invalid string format\n");
-            return;
+        /* Ensure each character is alphabetic, which also makes it fit in 15 bits */
+        if (!isalpha((unsigned char) startQuote[i + 1])) {
+            reportError(diagnostics, "Error - Invalid string format");
+            return 0;
         }
-        /* Store each character */
-        (*content)[i] = (unsigned short) startQuote[i + 1];
+        words[i] = (unsigned char) startQuote[i + 1];
     }
 
-    (*content)[length] = 0;  /* Null-terminate the string */
-    *dataCount = length + 1; /* Set the data count to the length of the string plus the null terminator */
+    words[length] = 0;  /* Null-terminate the string */
+    data->count += length + 1;
+    return length + 1;  /* The length of the string plus the null terminator */
 }
 
-/* Writes data line values to the data list. */
-void writeDataToList(int count, unsigned short *content, dataList **tail, int DC) {
-    int i;
-    /* Convert data to 15-bit format and Add to the data list */
-    for (i = 0; i < count; i++) {
-        content[i] = word15bits(content[i]);
-        addToDataList(tail, DC + i, content[i]);
+/* Processes the values of a data or string directive and updates the data segment. */
+void processDataLine(int directive, span values, int *DC, dataSegment *data, diagnosticList *diagnostics) {
+    /* Handle different types of directives, and update the data counter */
+    if (directive == KEYWORD_DATA) {
+        (*DC) += parseDataArray(values, data, diagnostics);
+    } else if (directive == KEYWORD_STRING) {
+        (*DC) += parseStringArray(values, data, diagnostics);
     }
 }
-/* Processes a line containing data or string directives and updates the data list. */
-void processDataLine(char *line, int *DC, dataList **tail) {
-    char directive[MAX_LINE_LENGTH];
-    unsigned short *content = NULL;
-    int dataCount  = 0;
-
-    /* Remove leading whitespace, directive from the line */
-    ignoreLeftWhiteSpaces(line);
-    sscanf(line, "%s", directive);
-    removeDirectiveFromLine(line);
-
-    /* Handle different types of directives */
-    if (strcmp(directive, ".data") == 0) {
-        parseDataArray(line, &content, &dataCount);
-        writeDataToList(dataCount, content, tail, *DC);
-    } else if (strcmp(directive, ".string") == 0) {
-        parseStringArray(line, &content, &dataCount);
-        writeDataToList(dataCount, content, tail, *DC);
-    }
 
-    /* Free allocated memory */
-    if (content) {
-        free(content);
-    }
-    /* Update the data counter */
-    (*DC) += dataCount;
-
-}
-
-/* Processes a line with an operation and updates the instruction list. */
-void processInstrctionline(char *line, instructionList **tail, int *IC) {
-
-    char operation[MAX_LINE_LENGTH];
-    char *sourceOperand = NULL, *destOperand = NULL;
-    int estOperands;
-    sscanf(line, "%s", operation); /* Extract the operation from the line */
-
-    ignoreLeftWhiteSpaces(line);
-    while (!isspace(*line)) { line++; } /* Remove operation from line */
-    estOperands = estimatedOperands(operation);
-
-    /* Validate operands and add to instruction list */
-    if (validateOperands(estOperands, line, &sourceOperand, &destOperand)) {
-
-        /* Add line to instruction line list*/
-        addInstructionLine(operation, sourceOperand, destOperand, *IC, tail);
-
-        /* Check for registers*/
-        if (estOperands > 1 && isRegister(sourceOperand) && isRegister(destOperand)) {
-            (*IC)++;
-        } else {
-            (*IC) += estOperands;
-        }
+/* Processes the operands of an operation and appends the instruction to the list. */
+void processInstrctionline(int opcode, span operands, instructionList *instructions, symbolTable *symTable,
+                           int *IC, diagnosticList *diagnostics) {
+    span sourceOperand, destOperand;
+    int estOperands = operandsOfOperation(opcode);
+    instruction *in;
+
+    /* Validate operands and classify them once, the words are written by encodeInstructions */
+    if (validateOperands(estOperands, operands, &sourceOperand, &destOperand, diagnostics)) {
+        in = addInstruction(instructions);
+        in->opcode = (unsigned char) opcode;
+        in->line = diagnostics->line;
+        parseOperand(sourceOperand, symTable, in, SOURCE_FLAG);
+        parseOperand(destOperand, symTable, in, DEST_FLAG);
+
+        (*IC) += instructionLength(in);
     } else {
-        errors++;
-        fprintf(stderr, "Error - invalid operands in line: %s\n", line);
+        operands = trimSpan(operands);
+        reportError(diagnostics, "Error - invalid operands in line: %.*s", operands.length, operands.start);
+
+        /* Increment instruction counter for the next instruction. */
+        (*IC)++;
     }
-    /* Increment instruction counter for the next instruction. */
-    (*IC)++;
 }
 
-/* Processes the first pass of the assembler to validate file content and prepare data and instruction lists. */
-void firstAssemblerPass(char *outputFileName, symbolTable *symTable, instructionList **Itail,
-                        dataList **Dtail, int *ICInitial, int *DCInitial) {
-    FILE * file;
-    int IC = 100, DC = 0;
-    char line[MAX_LINE_LENGTH + 1];
-
-    /* Open the file for reading */
-    file = fopen(outputFileName, "r");
-    if (file == NULL) {
-        fprintf(stderr, "Error opening file: %s\n", outputFileName);
-        return;
-    }
+/* Processes the first pass of the assembler to validate file content and collect the instructions and data. */
+int firstAssemblerPass(expandedProgram *program, symbolTable *symTable, instructionList *instructions,
+                       dataSegment *data, fixupList *fixups, diagnosticList *diagnostics,
+                       int *ICInitial, int *DCInitial) {
+    int IC = 100, DC = 0, errors = diagnostics->errors, i, id;
+    const tokenStream *tokens = program->tokens;
 
-    /* Process each line in the file */
-    while (fgets(line, sizeof(line), file)) {
-        char symbol[MAX_LABEL_LENGTH];
+    /* Process each line of the expanded program, the lines and their words were found by the lexer */
+    for (i = 0; i < program->count; i++) {
+        span line = lexedLineSpan(tokens, program->lines[i]), statement, word, symbol;
         bool symbolFlag = false;
 
-        /* Skipping comment or empty line */
-        if (isNoteLine(line) || isEmptyLine(line)) {
+        diagnostics->line = program->sourceLines[i];
+
+        /* Skipping comment or empty line, which has no words */
+        word = lexedWordSpan(tokens, program->lines[i], 0);
+        if (isNoteLine(line) || word.length == 0) {
             continue;
         }
 
         /* Handle label symbols */
-        if (isSymbol(line, symbol)) {
+        if (isSymbol(word, &symbol)) {
             symbolFlag = true;
 
             if (!isValidLabel(symbol)) {
-                errors++;
-                fprintf(stderr, "Error - invalid label: %s\n", symbol);
+                reportError(diagnostics, "Error - invalid label: %.*s", symbol.length, symbol.start);
                 continue;
             }
-            removeSymbolFromLine(line);
+            line = restOfLine(line, word);
+            word = lexedWordSpan(tokens, program->lines[i], 1);
         }
 
-        if (isDirectiveLine(line)) {
-            if (isExternalLine(line)) {
+        /* The rest of the line follows the directive or the operation */
+        statement = line;
+        id = keywordOf(word);
+        line = restOfLine(line, word);
+
+        if (IS_DIRECTIVE(id)) {
+            if (id == KEYWORD_EXTERN) {
                 handleExternalLine(line, symTable);
-            } else if (isDataOrString(line)) {
+            } else if (id == KEYWORD_ENTRY) {
+                handleEntryLine(line, symTable, fixups);
+            } else if (id == KEYWORD_DATA || id == KEYWORD_STRING) {
 
                 if (symbolFlag) {
-                    addSymbol(symTable, symbol, "data", DC);
+                    addSymbol(symTable, internName(symTable, symbol), SEGMENT_DATA, 0, DC);
                 }
 
-                processDataLine(line, &DC, Dtail);
+                processDataLine(id, line, &DC, data, diagnostics);
             }
-        } else if (isInstructionLine(line)) {
+        } else if (IS_OPERATION(id)) {
             if (symbolFlag) {
-                addSymbol(symTable, symbol, "code", IC);
+                addSymbol(symTable, internName(symTable, symbol), SEGMENT_CODE, 0, IC);
             }
 
-            processInstrctionline(line, Itail, &IC);
+            processInstrctionline(id, line, instructions, symTable, &IC, diagnostics);
         } else {
-            errors++;
-            fprintf(stderr, "Error - invalid format input: %s\n", line);
+            statement = trimSpan(statement);
+            reportError(diagnostics, "Error - invalid format input: %.*s", statement.length, statement.start);
         }
     }
 
     *ICInitial = IC;  /* Set the initial instruction counter */
     *DCInitial = DC;  /* Set the initial data counter */
 
-    /* Update symbol addresses*/
-    updateSymbolAddress(IC, symTable);
+    /* The data segment follows the code, data symbols are relative to it */
+    symTable->dataBase = IC;
+    diagnostics->line = 0;
 
-    fclose(file);
-
-}
\ No newline at end of file
+    return diagnostics->errors - errors;
+}
@@ -1,24 +1,36 @@
 #ifndef FIRSTRUN_H
 #define FIRSTRUN_H
 
+#include "diagnostics.h"
+#include "fixups.h"
+#include "header.h"
+#include "instructionList.h"
 #include "memory.h"
+#include "preProcessor.h"
 #include "symbolTable.h"
 
 /*
- * Processes the first pass of the assembler to validate file content and prepare data and instruction lists.
+ * Processes the first pass of the assembler to validate file content and collect the instructions and data.
  *
- * This function reads the content of the specified file, processes each line to handle symbols, directives,
- * and instructions, and updates the symbol table, instruction list, and data list accordingly. It also
- * calculates the initial instruction counter (IC) and data counter (DC) values.
+ * This function goes over the expanded lines, processes each line to handle symbols, directives,
+ * and instructions, and updates the symbol table, instruction list, and data segment accordingly. It also
+ * calculates the initial instruction counter (IC) and data counter (DC) values. Whatever depends on
+ * symbols defined later (.entry names and symbol operands) is recorded for resolveFixups, so the lines
+ * are read only once. The instructions are kept with their operands classified; encodeInstructions
+ * turns them into the code segment.
  *
- * @param outputFileName The name of the file to process.
+ * @param program The lines of the program after macro expansion.
  * @param symTable Pointer to the symbol table to be updated.
- * @param Itail Pointer to the instruction list tail to be updated.
- * @param Dtail Pointer to the data list tail to be updated.
+ * @param instructions Pointer to the instruction list to be filled.
+ * @param data Pointer to the data segment to be filled.
+ * @param fixups Pointer to the fixup list receiving the .entry names.
+ * @param diagnostics Receives the errors, on the source line of the expanded line.
  * @param ICInitial Pointer to store the initial instruction counter value.
  * @param DCInitial Pointer to store the initial data counter value.
+ * @return The number of errors found in the file.
  */
-void firstAssemblerPass(char *outputFileName, symbolTable *symTable, instructionList **Itail,
-                        dataList **Dtail, int *ICInitial, int *DCInitial);
+int firstAssemblerPass(expandedProgram *program, symbolTable *symTable, instructionList *instructions,
+                       dataSegment *data, fixupList *fixups, diagnosticList *diagnostics,
+                       int *ICInitial, int *DCInitial);
 
 #endif
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocation.h"
+#include "fixups.h"
+#include "machineCode.h"
+
+
+/* Initializes an empty fixup list. */
+fixupList *initFixupList() {
+    fixupList *fixups = allocateMemory(sizeof(fixupList));
+
+    fixups->entries = NULL;
+    fixups->entryCount = 0;
+    fixups->entryCapacity = 0;
+    fixups->externals = NULL;
+    fixups->externalCount = 0;
+    fixups->externalCapacity = 0;
+    return fixups;
+}
+
+/* Records a name given to a .entry directive. */
+void addEntryFixup(fixupList *fixups, int nameId) {
+    /* Grow the array of names geometrically */
+    if (fixups->entryCount == fixups->entryCapacity) {
+        fixups->entryCapacity = fixups->entryCapacity ? 2 * fixups->entryCapacity : INITIAL_FIXUPS_CAPACITY;
+        fixups->entries = reallocateMemory(fixups->entries, fixups->entryCapacity * sizeof(int));
+    }
+    fixups->entries[fixups->entryCount++] = nameId;
+}
+
+/* Records that the word at the given position refers to an external symbol. */
+static void addExternalReference(fixupList *fixups, symbolReference *reference) {
+    /* Grow the array of references geometrically */
+    if (fixups->externalCount == fixups->externalCapacity) {
+        fixups->externalCapacity = fixups->externalCapacity ? 2 * fixups->externalCapacity : INITIAL_FIXUPS_CAPACITY;
+        fixups->externals = reallocateMemory(fixups->externals, fixups->externalCapacity * sizeof(symbolReference));
+    }
+    fixups->externals[fixups->externalCount++] = *reference;
+}
+
+/* Marks a symbol as an entry in the symbol table. */
+void updateSymbolToEntry(symbolTable *symTable, int nameId, diagnosticList *diagnostics) {
+    Symbol *symbol = findSymbol(symTable, nameId);  /* Find the symbol in the symbol table */
+
+    if (symbol != NULL) {
+        if (symbol->flags & SYMBOL_EXTERNAL) {
+            reportWarning(diagnostics, "External symbol cannot be an entry: %s", poolString(symTable->names, nameId));
+        } else {
+            symbol->flags |= SYMBOL_ENTRY;  /* The segment of the symbol is kept */
+        }
+    } else {
+        reportWarning(diagnostics, "Entry symbol not found in symbol table: %s", poolString(symTable->names, nameId));
+    }
+}
+
+/* Updates the addresses of operands in the code segment based on the symbol table. */
+void updateOperandsAddress(codeSegment *code, symbolTable *symTable, fixupList *fixups, diagnosticList *diagnostics) {
+    Symbol *symbol;
+    symbolReference *reference;
+    int i;
+
+    /* Only the words in the reference table hold a symbol operand */
+    for (i = 0; i < code->referenceCount; i++) {
+        reference = &code->references[i];
+        symbol = findSymbol(symTable, reference->nameId);  /* Find the symbol in the table */
+
+        if (symbol != NULL) {
+            code->words[reference->position] = writeLabelAddress(symTable, symbol);  /* Update the word with the symbol's address */
+            if (symbol->flags & SYMBOL_EXTERNAL) {
+                addExternalReference(fixups, reference);  /* The word goes to the .ext file */
+            }
+        } else {
+            reportWarning(diagnostics, "Symbol not found for operand: %s", poolString(symTable->names, reference->nameId));
+        }
+    }
+}
+
+/* Resolves the fixups against the symbol table. */
+void resolveFixups(fixupList *fixups, symbolTable *symTable, codeSegment *code, diagnosticList *diagnostics) {
+    int i;
+
+    for (i = 0; i < fixups->entryCount; i++) {
+        updateSymbolToEntry(symTable, fixups->entries[i], diagnostics);  /* Process .entry names */
+    }
+    updateOperandsAddress(code, symTable, fixups, diagnostics);  /* Update operand addresses based on the symbol table */
+}
+
+/* Removes every fixup from the list, keeping its memory. */
+void clearFixupList(fixupList *fixups) {
+    fixups->entryCount = 0;
+    fixups->externalCount = 0;
+}
+
+/* Frees the fixup list. */
+void freeFixupList(fixupList *fixups) {
+    free(fixups->entries);
+    free(fixups->externals);
+    free(fixups);
+}
@@ -0,0 +1,73 @@
+#ifndef FIXUPS_H
+#define FIXUPS_H
+
+#include "diagnostics.h"
+#include "header.h"
+#include "memory.h"
+#include "symbolTable.h"
+
+#define INITIAL_FIXUPS_CAPACITY 16
+
+/* Structure representing the fixups the first pass leaves to be resolved once the whole
+ * symbol table is known: the names of the .entry directives. The operand words that hold
+ * the address of a symbol are kept in the reference table of the code segment; those
+ * that resolve to an external symbol are collected here for the .ext file. */
+typedef struct {
+    int *entries;                  /* IDs of the names given to .entry directives, in order */
+    int entryCount;                /* Number of entry names */
+    int entryCapacity;             /* Number of names the array can hold */
+    symbolReference *externals;    /* Operand words resolved to an external symbol, in order */
+    int externalCount;             /* Number of external references */
+    int externalCapacity;          /* Number of references the array can hold */
+} fixupList;
+
+/*
+ * Initializes an empty fixup list.
+ *
+ * @return A pointer to the newly created fixup list.
+ */
+fixupList *initFixupList();
+
+/*
+ * Records a name given to a .entry directive.
+ *
+ * The array of names grows geometrically.
+ *
+ * @param fixups A pointer to the fixup list.
+ * @param nameId The ID of the name of the entry symbol.
+ */
+void addEntryFixup(fixupList *fixups, int nameId);
+
+/*
+ * Resolves the fixups against the symbol table.
+ *
+ * This function marks the symbols named by .entry directives as entries, and writes the
+ * address of every symbol operand into its word in the code segment. It replaces a second
+ * pass over the source: the lines are not read again. Every word that gets the E bit is
+ * recorded in the external references of the fixup list.
+ *
+ * @param fixups The fixups recorded by the first pass.
+ * @param symTable The symbol table used for updating entry symbols and finding symbol addresses.
+ * @param code The code segment whose symbol operands are updated.
+ * @param diagnostics Receives a warning for each name that could not be resolved; as in the
+ *                    two pass assembler, the source still assembles, with 0 in the word.
+ */
+void resolveFixups(fixupList *fixups, symbolTable *symTable, codeSegment *code, diagnosticList *diagnostics);
+
+/*
+ * Removes every fixup from the list.
+ *
+ * The memory of the list is kept for the next source.
+ *
+ * @param fixups A pointer to the fixup list.
+ */
+void clearFixupList(fixupList *fixups);
+
+/*
+ * Frees the fixup list.
+ *
+ * @param fixups A pointer to the fixup list to be freed.
+ */
+void freeFixupList(fixupList *fixups);
+
+#endif
@@ -11,12 +11,10 @@
 #define OPERATIONS_LENGTH 4
 #define MAX_LABEL_LENGTH 31
 
-#endif
-
-bool isInstruction(char *name);
-bool isDirective(char *name);
-
-
-
-
+/* A piece of the source text: it points into the source and is not null terminated. */
+typedef struct {
+    const char *start;        /* First character, NULL for a missing piece */
+    int length;               /* Number of characters */
+} span;
 
+#endif
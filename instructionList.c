@@ -0,0 +1,38 @@
+#include <stdlib.h>
+
+#include "allocation.h"
+#include "instructionList.h"
+
+
+/* Initializes an empty instruction list. */
+instructionList *initInstructionList() {
+    instructionList *instructions = allocateMemory(sizeof(instructionList));
+
+    instructions->items = allocateMemory(INITIAL_INSTRUCTIONS_CAPACITY * sizeof(instruction));
+    instructions->count = 0;
+    instructions->capacity = INITIAL_INSTRUCTIONS_CAPACITY;
+    return instructions;
+}
+
+/* Appends an instruction to the list and returns it. */
+instruction *addInstruction(instructionList *instructions) {
+    /* Double the list when it is full */
+    if (instructions->count == instructions->capacity) {
+        instructions->items = reallocateMemory(instructions->items, 2 * instructions->capacity * sizeof(instruction));
+        instructions->capacity *= 2;
+    }
+    return &instructions->items[instructions->count++];
+}
+
+/* Removes every instruction from the list, keeping its memory. */
+void clearInstructionList(instructionList *instructions) {
+    instructions->count = 0;
+}
+
+/* Frees the instruction list. */
+void freeInstructionList(instructionList *instructions) {
+    if (instructions != NULL) {
+        free(instructions->items);
+        free(instructions);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef INSTRUCTION_LIST_H
+#define INSTRUCTION_LIST_H
+
+#include "header.h"
+
+#define INITIAL_INSTRUCTIONS_CAPACITY 256
+
+/* Addressing mode of an operand the instruction does not have */
+#define NO_OPERAND (-1)
+
+/*
+ * Structure representing an instruction after parsing: its operands are classified once,
+ * by the first pass, and encodeInstructions turns it into words.
+ *
+ * The operands are indexed by SOURCE_FLAG and DEST_FLAG; an operation with a single operand
+ * has it as the destination. The value of an operand is the register number of a register
+ * operand, the value of an immediate operand, and the ID of the name of a symbol operand.
+ */
+typedef struct {
+    unsigned char opcode;     /* The keyword ID of the operation */
+    signed char modes[2];     /* Addressing mode of each operand, or NO_OPERAND */
+    int values[2];            /* The value of each operand */
+    int line;                 /* Number of the source line, the line of the macro call for the lines of a macro */
+} instruction;
+
+/* Structure holding the instructions of a program, in order of their address. */
+typedef struct {
+    instruction *items;       /* The instructions */
+    int count;                /* Number of instructions */
+    int capacity;             /* Number of instructions the array can hold */
+} instructionList;
+
+/*
+ * Initializes an empty instruction list.
+ *
+ * @return A pointer to the newly created instruction list.
+ */
+instructionList *initInstructionList();
+
+/*
+ * Appends an instruction to the list.
+ *
+ * The list grows geometrically when it is full.
+ *
+ * @param instructions A pointer to the instruction list.
+ * @return The new instruction, to be filled by the caller.
+ */
+instruction *addInstruction(instructionList *instructions);
+
+/*
+ * Removes every instruction from the list.
+ *
+ * The memory of the list is kept for the next source.
+ *
+ * @param instructions A pointer to the instruction list.
+ */
+void clearInstructionList(instructionList *instructions);
+
+/*
+ * Frees the instruction list.
+ *
+ * @param instructions A pointer to the instruction list to be freed, or NULL.
+ */
+void freeInstructionList(instructionList *instructions);
+
+#endif
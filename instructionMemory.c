@@ -1,68 +1,92 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
+#include "allocation.h"
 #include "memory.h"
 
 
-/* Initializes the instruction list with a single node. */
-instructionList *initInstructionList() {
-    return allocateNewINode(); /* Initialize with a single node */
+/* Initializes an empty code segment. */
+codeSegment *initCodeSegment() {
+
+    /* Allocate memory for the segment, its words and its reference table */
+    codeSegment *segment = allocateMemory(sizeof(codeSegment));
+
+    segment->words = allocateMemory(INITIAL_SEGMENT_CAPACITY * sizeof(unsigned short));
+    segment->references = allocateMemory(INITIAL_SEGMENT_CAPACITY * sizeof(symbolReference));
+
+    /* Initialize segment fields */
+    segment->count = 0;
+    segment->capacity = INITIAL_SEGMENT_CAPACITY;
+    segment->referenceCount = 0;
+    segment->referenceCapacity = INITIAL_SEGMENT_CAPACITY;
+    segment->keepLines = false;
+    segment->line = 0;
+    segment->lines = NULL;
+    segment->lineCount = 0;
+    segment->lineCapacity = 0;
+    return segment;
 }
 
-/* Allocates and initializes a new instruction list node. */
-instructionList *allocateNewINode() {
+/* Records that the word at the given position holds the address of a symbol. */
+static void addSymbolReference(codeSegment *segment, int nameId, int position) {
+    symbolReference *reference;
 
-    /* Allocate memory for new node */
-    instructionList *newNode = malloc(sizeof(instructionList));
-    if (newNode == NULL) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(EXIT_FAILURE);
+    /* Double the reference table when it is full */
+    if (segment->referenceCount == segment->referenceCapacity) {
+        segment->referenceCapacity *= 2;
+        segment->references = reallocateMemory(segment->references, segment->referenceCapacity * sizeof(symbolReference));
     }
 
-    /* Initialize node fields */
-    newNode->count = 0;
-    newNode->line = 0;
-    newNode->symbolOperand = NULL;
-    newNode->next = NULL;
-    return newNode;
+    reference = &segment->references[segment->referenceCount];
+    reference->nameId = nameId;
+    reference->position = position;
+    segment->referenceCount++;
 }
 
-/* Adds a new line to the instruction list and allocates a new node. */
-void addToInstructionList(instructionList **tail,char *operand, int count,unsigned short line) {
-
-    /* Set the values of the current tail node */
-    (*tail)->count = count;
-    (*tail)->line = line;
-
-    /* Allocate and copy the operand string if it is not NULL */
-    if (operand != NULL) {
-        (*tail)->symbolOperand = malloc(strlen(operand)+1);
-        if ((*tail)->symbolOperand == NULL) {
-            fprintf(stderr, "Memory allocation failed for symbolOperand\n");
-            exit(EXIT_FAILURE);
-        }
-        strcpy((*tail)->symbolOperand, operand);
+/* Records that the next word starts the words of the current source line. */
+static void addLineRecord(codeSegment *segment) {
+    /* Grow the table geometrically, it is only allocated when lines are kept */
+    if (segment->lineCount == segment->lineCapacity) {
+        segment->lineCapacity = segment->lineCapacity ? 2 * segment->lineCapacity : INITIAL_SEGMENT_CAPACITY;
+        segment->lines = reallocateMemory(segment->lines, segment->lineCapacity * sizeof(lineRecord));
     }
 
+    segment->lines[segment->lineCount].position = segment->count;
+    segment->lines[segment->lineCount].line = segment->line;
+    segment->lineCount++;
+}
+
+/* Appends a word to the code segment, and records its symbol operand if it has one. */
+void addToCodeSegment(codeSegment *segment, int nameId, unsigned short line) {
 
-    /* Allocate the next node */
-    (*tail)->next = allocateNewINode();
+    /* Double the segment when it is full */
+    if (segment->count == segment->capacity) {
+        segment->capacity *= 2;
+        segment->words = reallocateMemory(segment->words, segment->capacity * sizeof(unsigned short));
+    }
 
-    /* Move the tail to the next node */
-    *tail = (*tail)->next;
+    if (nameId != NO_STRING) {
+        addSymbolReference(segment, nameId, segment->count);
+    }
+    if (segment->keepLines && (segment->lineCount == 0 || segment->lines[segment->lineCount - 1].line != segment->line)) {
+        addLineRecord(segment);
+    }
+    segment->words[segment->count++] = line;
 }
 
-/* Frees all nodes in the instruction list and their symbol operands. */
-void freeInstructionList(instructionList *head) {
-    instructionList *current = head;
-    instructionList *next;
+/* Removes every word and reference from the code segment, keeping its memory. */
+void clearCodeSegment(codeSegment *segment) {
+    segment->count = 0;
+    segment->referenceCount = 0;
+    segment->lineCount = 0;
+}
 
-    while (current != NULL) {
-        next = current->next;
-        free(current->symbolOperand); /* Free the symbol operand if allocated */
-        free(current);
-        current = next;
+/* Frees the code segment and its reference table. */
+void freeCodeSegment(codeSegment *segment) {
+    if (segment != NULL) {
+        free(segment->references);
+        free(segment->lines);
+        free(segment->words);
+        free(segment);
     }
-    head = NULL;
-}
\ No newline at end of file
+}
@@ -0,0 +1,120 @@
+/*
+ * keywordGenerator.c
+ *
+ * Description:
+ * Generates keywordTable.h, the perfect-hash table keywords.c looks words up in.
+ * The hash of a keyword is
+ *     (A * first character + B * second character + C * last character + length) mod size
+ * and the generator searches the smallest table, then the smallest multipliers, for
+ * which no two keywords fall into the same slot. The makefile runs it at build time,
+ * so a keyword added to the list below gets its slot without editing a table by hand;
+ * its ID is defined in keywords.h.
+ *
+ * Usage:
+ *   ./keywordGenerator > keywordTable.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define MIN_TABLE_SIZE 32
+#define MAX_TABLE_SIZE 1024
+#define MAX_MULTIPLIER 31
+
+/* Structure representing a keyword and the expression of its ID in keywords.h. */
+typedef struct {
+    const char *name;   /* The keyword */
+    const char *id;     /* The keyword ID, as written in the table */
+} keywordSpec;
+
+static const keywordSpec keywords[] = {
+    {"mov", "OP_MOV"}, {"cmp", "OP_CMP"}, {"add", "OP_ADD"}, {"sub", "OP_SUB"},
+    {"lea", "OP_LEA"}, {"clr", "OP_CLR"}, {"not", "OP_NOT"}, {"inc", "OP_INC"},
+    {"dec", "OP_DEC"}, {"jmp", "OP_JMP"}, {"bne", "OP_BNE"}, {"red", "OP_RED"},
+    {"prn", "OP_PRN"}, {"jsr", "OP_JSR"}, {"rts", "OP_RTS"}, {"stop", "OP_STOP"},
+    {".data", "KEYWORD_DATA"}, {".string", "KEYWORD_STRING"},
+    {".entry", "KEYWORD_ENTRY"}, {".extern", "KEYWORD_EXTERN"},
+    {"r0", "KEYWORD_R0 + 0"}, {"r1", "KEYWORD_R0 + 1"}, {"r2", "KEYWORD_R0 + 2"}, {"r3", "KEYWORD_R0 + 3"},
+    {"r4", "KEYWORD_R0 + 4"}, {"r5", "KEYWORD_R0 + 5"}, {"r6", "KEYWORD_R0 + 6"}, {"r7", "KEYWORD_R0 + 7"},
+    {"macr", "KEYWORD_MACR"}, {"endmacr", "KEYWORD_ENDMACR"}
+};
+
+#define KEYWORDS ((int) (sizeof(keywords) / sizeof(keywords[0])))
+
+/* Returns the slot of a keyword for the given multipliers and table size. */
+static int keywordSlot(const char *name, int a, int b, int c, int size) {
+    int length = (int) strlen(name);
+    return (a * (unsigned char) name[0] + b * (unsigned char) name[1] +
+            c * (unsigned char) name[length - 1] + length) & (size - 1);
+}
+
+/* Fills the slots of the keywords, returns 0 if two keywords share a slot. */
+static int placeKeywords(int a, int b, int c, int size, int *slots) {
+    int i, slot;
+
+    for (i = 0; i < size; i++) {
+        slots[i] = -1;
+    }
+    for (i = 0; i < KEYWORDS; i++) {
+        slot = keywordSlot(keywords[i].name, a, b, c, size);
+        if (slots[slot] >= 0) {
+            return 0;
+        }
+        slots[slot] = i;
+    }
+    return 1;
+}
+
+/*
+ * Main function of the generator.
+ * @return 0 if a table was written, 1 if no multipliers separate the keywords.
+ */
+int main(void) {
+    static int slots[MAX_TABLE_SIZE];
+    int size, a, b, c, i, length, minLength = 0, maxLength = 0;
+
+    for (i = 0; i < KEYWORDS; i++) {
+        length = (int) strlen(keywords[i].name);
+        if (i == 0 || length < minLength) {
+            minLength = length;
+        }
+        if (length > maxLength) {
+            maxLength = length;
+        }
+    }
+
+    for (size = MIN_TABLE_SIZE; size <= MAX_TABLE_SIZE; size *= 2) {
+        for (a = 1; a <= MAX_MULTIPLIER; a++) {
+            for (b = 1; b <= MAX_MULTIPLIER; b++) {
+                for (c = 1; c <= MAX_MULTIPLIER; c++) {
+                    if (placeKeywords(a, b, c, size, slots)) {
+                        goto found;
+                    }
+                }
+            }
+        }
+    }
+    fprintf(stderr, "No perfect hash of the keywords fits in %d slots\n", MAX_TABLE_SIZE);
+    return 1;
+
+found:
+    printf("/* Generated by keywordGenerator, do not edit */\n\n");
+    printf("#define KEYWORD_TABLE_SIZE %d\n", size);
+    printf("#define MIN_KEYWORD_LENGTH %d\n", minLength);
+    printf("#define MAX_KEYWORD_LENGTH %d\n\n", maxLength);
+    printf("/* Perfect hash of the keywords: no two keywords fall into the same slot */\n");
+    printf("#define KEYWORD_HASH(name, length) \\\n");
+    printf("    ((%d * (unsigned char) (name)[0] + %d * (unsigned char) (name)[1] + \\\n", a, b);
+    printf("      %d * (unsigned char) (name)[(length) - 1] + (length)) & (KEYWORD_TABLE_SIZE - 1))\n\n", c);
+    printf("/* Keyword table, indexed by KEYWORD_HASH */\n");
+    printf("static const keywordEntry keywordTable[KEYWORD_TABLE_SIZE] = {\n");
+    for (i = 0; i < size; i++) {
+        if (slots[i] >= 0) {
+            printf("    {\"%s\", %s}, /* %d */\n", keywords[slots[i]].name, keywords[slots[i]].id, i);
+        } else {
+            printf("    {NULL, KEYWORD_NONE}, /* %d */\n", i);
+        }
+    }
+    printf("};\n");
+    return 0;
+}
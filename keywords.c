@@ -0,0 +1,44 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "keywords.h"
+
+/* Structure representing a slot of the keyword table. */
+typedef struct {
+    const char *name;   /* The keyword, or NULL for an empty slot */
+    int id;             /* The keyword ID */
+} keywordEntry;
+
+/*
+ * The perfect-hash table of the keywords, KEYWORD_HASH and the bounds of their lengths are
+ * generated by keywordGenerator, which searches the multipliers of the hash at build time.
+ */
+#include "keywordTable.h"
+
+/* Number of operands of each operation, indexed by opcode */
+static const int operationOperands[OPERATIONS] = {
+    2, 2, 2, 2, 2,              /* mov, cmp, add, sub, lea */
+    1, 1, 1, 1, 1, 1, 1, 1, 1,  /* clr, not, inc, dec, jmp, bne, red, prn, jsr */
+    0, 0                        /* rts, stop */
+};
+
+/* Looks a word that is not null terminated up in the keyword table */
+int findKeywordSpan(const char *name, int length) {
+    const keywordEntry *entry;
+
+    if (length < MIN_KEYWORD_LENGTH || length > MAX_KEYWORD_LENGTH) {
+        return KEYWORD_NONE;
+    }
+
+    entry = &keywordTable[KEYWORD_HASH(name, length)];
+    if (entry->name != NULL && strncmp(entry->name, name, length) == 0 && entry->name[length] == '\0') {
+        return entry->id;
+    }
+    return KEYWORD_NONE;
+}
+
+/* Returns the number of operands an operation takes */
+int operandsOfOperation(int opcode) {
+    return IS_OPERATION(opcode) ? operationOperands[opcode] : 0;
+}
+
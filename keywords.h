@@ -0,0 +1,60 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include "header.h"
+
+/* Keyword IDs. The ID of an operation is its opcode. */
+#define KEYWORD_NONE (-1)
+
+#define OP_MOV 0
+#define OP_CMP 1
+#define OP_ADD 2
+#define OP_SUB 3
+#define OP_LEA 4
+#define OP_CLR 5
+#define OP_NOT 6
+#define OP_INC 7
+#define OP_DEC 8
+#define OP_JMP 9
+#define OP_BNE 10
+#define OP_RED 11
+#define OP_PRN 12
+#define OP_JSR 13
+#define OP_RTS 14
+#define OP_STOP 15
+
+#define KEYWORD_DATA 16
+#define KEYWORD_STRING 17
+#define KEYWORD_ENTRY 18
+#define KEYWORD_EXTERN 19
+#define KEYWORD_R0 20             /* Register n has the ID KEYWORD_R0 + n */
+#define KEYWORD_MACR 28
+#define KEYWORD_ENDMACR 29
+
+#define IS_OPERATION(id) ((id) >= OP_MOV && (id) <= OP_STOP)
+#define IS_DIRECTIVE(id) ((id) >= KEYWORD_DATA && (id) <= KEYWORD_EXTERN)
+#define IS_REGISTER(id) ((id) >= KEYWORD_R0 && (id) < KEYWORD_R0 + REGISTERS)
+#define REGISTER_NUMBER(id) ((id) - KEYWORD_R0)
+
+/*
+ * Looks a word up in the keyword table, without needing a null terminated copy of it.
+ *
+ * The table is indexed by a perfect hash of the word, so a single probe and one
+ * string comparison decide whether the word is an operation, a directive,
+ * a register or a macro keyword.
+ *
+ * @param name The first character of the word.
+ * @param length The number of characters in the word.
+ * @return The keyword ID of the word, or KEYWORD_NONE if it is not a keyword.
+ */
+int findKeywordSpan(const char *name, int length);
+
+/*
+ * Returns the number of operands an operation takes.
+ *
+ * @param opcode The keyword ID of the operation.
+ * @return The number of operands, 0 if the ID is not an operation.
+ */
+int operandsOfOperation(int opcode);
+
+#endif
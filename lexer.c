@@ -0,0 +1,220 @@
+#include <stdlib.h>
+
+#include "allocation.h"
+#include "lexer.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Bytes classified at once: one bit each in a mask of 32 bits */
+#define LEX_BLOCK 32
+#define BLOCK_MASK 0xFFFFFFFFUL
+
+/*
+ * White space is what isspace accepts in the C locale: the space, and the characters
+ * from tab to carriage return. As signed bytes, c + (128 - '\t') runs from -128 up for
+ * those, so a single signed comparison finds them.
+ */
+#define SPACE_SHIFT (128 - '\t')
+#define SPACE_LIMIT (-128 + ('\r' - '\t') + 1)
+
+#if defined(__AVX2__)
+/* Returns a vector of 0xFF for the white space bytes of a vector. */
+static __m256i spaceBytes(__m256i bytes) {
+    __m256i shifted = _mm256_add_epi8(bytes, _mm256_set1_epi8((char) SPACE_SHIFT));
+    return _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+                           _mm256_cmpgt_epi8(_mm256_set1_epi8((char) SPACE_LIMIT), shifted));
+}
+#elif defined(__SSE2__)
+/* Returns a vector of 0xFF for the white space bytes of a vector. */
+static __m128i spaceBytes(__m128i bytes) {
+    __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8((char) SPACE_SHIFT));
+    return _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                        _mm_cmplt_epi8(shifted, _mm_set1_epi8((char) SPACE_LIMIT)));
+}
+#endif
+
+/*
+ * Classifies a block of bytes.
+ * @param bytes The bytes.
+ * @param count The number of bytes, LEX_BLOCK but for the last block of the text.
+ * @param spaces Receives a bit for each white space byte; the bits past the count are set.
+ * @param newlines Receives a bit for each line feed.
+ */
+static void classifyBlock(const char *bytes, int count, unsigned long *spaces, unsigned long *newlines) {
+    unsigned char c;
+    int i;
+
+#if defined(__AVX2__)
+    if (count == LEX_BLOCK) {
+        __m256i block = _mm256_loadu_si256((const __m256i *) bytes);
+        *spaces = (unsigned long) (unsigned) _mm256_movemask_epi8(spaceBytes(block));
+        *newlines = (unsigned long) (unsigned) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n')));
+        return;
+    }
+#elif defined(__SSE2__)
+    if (count == LEX_BLOCK) {
+        __m128i low = _mm_loadu_si128((const __m128i *) bytes);
+        __m128i high = _mm_loadu_si128((const __m128i *) (bytes + 16));
+        __m128i newline = _mm_set1_epi8('\n');
+        *spaces = (unsigned long) (unsigned) _mm_movemask_epi8(spaceBytes(low)) |
+                  (unsigned long) (unsigned) _mm_movemask_epi8(spaceBytes(high)) << 16;
+        *newlines = (unsigned long) (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(low, newline)) |
+                    (unsigned long) (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(high, newline)) << 16;
+        return;
+    }
+#endif
+
+    *spaces = *newlines = 0;
+    for (i = 0; i < LEX_BLOCK; i++) {
+        c = i < count ? (unsigned char) bytes[i] : ' ';
+        if (c == ' ' || (c >= '\t' && c <= '\r')) {
+            *spaces |= 1UL << i;
+        }
+        if (i < count && c == '\n') {
+            *newlines |= 1UL << i;
+        }
+    }
+}
+
+/* Returns the number of the lowest set bit of a mask that is not zero. */
+static int lowestBit(unsigned long mask) {
+#ifdef __GNUC__
+    return __builtin_ctzl(mask);
+#else
+    int bit = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/* Appends a word of the line starting at an offset. */
+static void addWord(tokenStream *tokens, long lineStart, long start, long end) {
+    int capacity;
+
+    if (tokens->wordCount == tokens->wordCapacity) {
+        capacity = tokens->wordCapacity ? 2 * tokens->wordCapacity : INITIAL_LEXED_WORDS;
+        tokens->words = reallocateMemory(tokens->words, capacity * sizeof(lexedWord));
+        tokens->wordCapacity = capacity;
+    }
+    tokens->words[tokens->wordCount].offset = (int) (start - lineStart);
+    tokens->words[tokens->wordCount++].length = (int) (end - start);
+}
+
+/* Appends a line, whose words were appended since its first one; one more entry is kept for the end. */
+static void addLine(tokenStream *tokens, long start, long end, int firstWord) {
+    int capacity;
+
+    if (tokens->lineCount + 1 >= tokens->lineCapacity) {
+        capacity = tokens->lineCapacity ? 2 * tokens->lineCapacity : INITIAL_LEXED_LINES;
+        tokens->lines = reallocateMemory(tokens->lines, capacity * sizeof(lexedLine));
+        tokens->lineCapacity = capacity;
+    }
+    tokens->lines[tokens->lineCount].start = start;
+    tokens->lines[tokens->lineCount].length = (int) (end - start);
+    tokens->lines[tokens->lineCount++].firstWord = firstWord;
+}
+
+/* Initializes an empty token stream. */
+void initTokenStream(tokenStream *tokens) {
+    tokens->text = NULL;
+    tokens->lines = NULL;
+    tokens->words = NULL;
+    tokens->lineCount = tokens->lineCapacity = 0;
+    tokens->wordCount = tokens->wordCapacity = 0;
+}
+
+/* Splits a whole source text into lines and words. */
+void lexSource(sourceBuffer *source, tokenStream *tokens) {
+    unsigned long spaces, newlines, previous, starts, ends, events, bit;
+    long base, position, lineStart = 0, wordStart = 0;
+    int lineWords = 0, count;
+    bool inWord = false;
+
+    tokens->text = source->text;
+    tokens->lineCount = tokens->wordCount = 0;
+
+    /*
+     * A word starts at a byte that is not white space after one that is, and ends at the
+     * white space after it; the bytes past the text count as white space, so the last
+     * word ends in the last block.
+     */
+    for (base = 0; base < source->length; base += LEX_BLOCK) {
+        count = source->length - base < LEX_BLOCK ? (int) (source->length - base) : LEX_BLOCK;
+        classifyBlock(source->text + base, count, &spaces, &newlines);
+
+        previous = ((spaces << 1) | (inWord ? 0 : 1)) & BLOCK_MASK;
+        starts = ~spaces & previous & BLOCK_MASK;
+        ends = spaces & ~previous & BLOCK_MASK;
+        events = starts | ends | newlines;
+
+        while (events != 0) {
+            bit = events & (~events + 1);
+            position = base + lowestBit(events);
+            if (starts & bit) {
+                wordStart = position;
+            }
+            if (ends & bit) {
+                addWord(tokens, lineStart, wordStart, position);
+            }
+            if (newlines & bit) {
+                addLine(tokens, lineStart, position, lineWords);
+                lineStart = position + 1;
+                lineWords = tokens->wordCount;
+            }
+            events &= events - 1;
+        }
+        inWord = !((spaces >> (LEX_BLOCK - 1)) & 1);
+    }
+    if (inWord) {
+        addWord(tokens, lineStart, wordStart, source->length);
+    }
+
+    /* The last line has no line feed */
+    if (lineStart < source->length) {
+        addLine(tokens, lineStart, source->length, lineWords);
+    }
+
+    /* The entry past the last line ends the words of the last line */
+    addLine(tokens, source->length, source->length, tokens->wordCount);
+    tokens->lineCount--;
+}
+
+/* Returns a line of a stream. */
+span lexedLineSpan(const tokenStream *tokens, int line) {
+    span s;
+    s.start = tokens->text + tokens->lines[line].start;
+    s.length = tokens->lines[line].length;
+    return s;
+}
+
+/* Returns a word of a line of a stream, or an empty span at the end of the line. */
+span lexedWordSpan(const tokenStream *tokens, int line, int word) {
+    const lexedLine *lexed = &tokens->lines[line];
+    const char *start = tokens->text + lexed->start;
+    span s;
+
+    word += lexed->firstWord;
+    if (word < lexed[1].firstWord) {
+        s.start = start + tokens->words[word].offset;
+        s.length = tokens->words[word].length;
+    } else {
+        s.start = start + lexed->length;
+        s.length = 0;
+    }
+    return s;
+}
+
+/* Frees the lines and the words of a stream. */
+void freeTokenStream(tokenStream *tokens) {
+    free(tokens->lines);
+    free(tokens->words);
+    initTokenStream(tokens);
+}
@@ -0,0 +1,87 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stdbool.h>
+
+#include "header.h"
+#include "sourceReader.h"
+
+#define INITIAL_LEXED_LINES 256
+#define INITIAL_LEXED_WORDS 1024
+
+/* Structure representing a word of a line: a run of characters other than white space. */
+typedef struct {
+    int offset;               /* Offset of the first character from the start of the line */
+    int length;               /* Number of characters */
+} lexedWord;
+
+/* Structure representing a line of the source text. */
+typedef struct {
+    long start;               /* Offset of the first character in the text */
+    int length;               /* Number of characters, without the line feed */
+    int firstWord;            /* Index of the first word of the line in the words of the stream */
+} lexedLine;
+
+/*
+ * Structure holding the lines of a source text and the words of each line.
+ *
+ * The words of line i are words[lines[i].firstWord] up to words[lines[i + 1].firstWord];
+ * a last line entry past lineCount marks the end of the words.
+ */
+typedef struct {
+    const char *text;         /* The text the lines point into */
+    lexedLine *lines;         /* The lines, in the order of the text */
+    int lineCount;            /* Number of lines */
+    int lineCapacity;         /* Number of lines the array can hold */
+    lexedWord *words;         /* The words of all the lines */
+    int wordCount;            /* Number of words */
+    int wordCapacity;         /* Number of words the array can hold */
+} tokenStream;
+
+/*
+ * Initializes an empty token stream.
+ *
+ * @param tokens The stream to initialize.
+ */
+void initTokenStream(tokenStream *tokens);
+
+/*
+ * Splits a whole source text into lines, and the lines into words, in one sweep.
+ *
+ * The text is classified a block of bytes at a time with SSE2 or AVX2 when the compiler
+ * targets them, and a byte at a time otherwise. Lines end at line feeds and words at
+ * white space, as firstWord finds them. The stream keeps the memory of the text it held
+ * before.
+ *
+ * @param source The source text, which must stay open as long as the stream is used.
+ * @param tokens Receives the lines and the words.
+ */
+void lexSource(sourceBuffer *source, tokenStream *tokens);
+
+/*
+ * Returns a line of a stream.
+ *
+ * @param tokens The stream.
+ * @param line The number of the line, from 0.
+ * @return The line, without its line feed.
+ */
+span lexedLineSpan(const tokenStream *tokens, int line);
+
+/*
+ * Returns a word of a line of a stream.
+ *
+ * @param tokens The stream.
+ * @param line The number of the line, from 0.
+ * @param word The number of the word in the line, from 0.
+ * @return The word, or an empty span at the end of the line when the line has fewer words.
+ */
+span lexedWordSpan(const tokenStream *tokens, int line, int word);
+
+/*
+ * Frees the lines and the words of a stream and leaves it empty.
+ *
+ * @param tokens The stream to free.
+ */
+void freeTokenStream(tokenStream *tokens);
+
+#endif
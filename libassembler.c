@@ -0,0 +1,251 @@
+#include <setjmp.h>
+#include <stdlib.h>
+
+#include "allocation.h"
+#include "cache.h"
+#include "firstRun.h"
+#include "fixups.h"
+#include "instructionList.h"
+#include "libassembler.h"
+#include "machineCode.h"
+#include "macro.h"
+#include "memory.h"
+#include "objectFile.h"
+#include "preProcessor.h"
+#include "symbolTable.h"
+
+/* Structure holding the state of the assembler. The tables, the buffers and the arrays of lines
+ * are emptied after each source and keep their memory, so the next source starts warm. */
+struct assemblerContext {
+    jmp_buf onFailure;            /* Where an allocation failure goes back to */
+    macroTable *macros;           /* The macros of the source */
+    symbolTable *symTable;        /* The symbols of the source */
+    instructionList *instructions; /* The instructions, before they are encoded */
+    codeSegment *code;            /* The code words */
+    dataSegment *data;            /* The data words */
+    fixupList *fixups;            /* The entries and the external references */
+    tokenStream tokens;           /* The lines and the words of the source */
+    expandedProgram program;      /* The lines after macro expansion */
+    objectModule module;          /* The output of the source, before it is formatted */
+    assemblyResult result;        /* What the last assembly produced */
+};
+
+/* Creates an assembler context. */
+assemblerContext *initAssemblerContext() {
+    assemblerContext *context = malloc(sizeof(assemblerContext));
+    if (context == NULL) {
+        return NULL;
+    }
+
+    context->macros = NULL;
+    context->symTable = NULL;
+    context->instructions = NULL;
+    context->code = NULL;
+    context->data = NULL;
+    context->fixups = NULL;
+    initTokenStream(&context->tokens);
+    initExpandedProgram(&context->program, NULL);
+    initObjectModule(&context->module);
+
+    context->result.status = ASSEMBLY_SUCCESS;
+    initObjectBuffers(&context->result.output);
+    initByteBuffer(&context->result.expanded);
+    initDiagnostics(&context->result.diagnostics);
+    initStats(&context->result.stats);
+    return context;
+}
+
+/* Empties the tables of the last source, keeping their memory. */
+static void clearSourceTables(assemblerContext *context) {
+    if (context->macros != NULL) {
+        clearMacros(context->macros);
+    }
+    if (context->symTable != NULL) {
+        clearSymbolTable(context->symTable);
+    }
+    if (context->instructions != NULL) {
+        clearInstructionList(context->instructions);
+    }
+    if (context->code != NULL) {
+        clearCodeSegment(context->code);
+    }
+    if (context->data != NULL) {
+        clearDataSegment(context->data);
+    }
+    if (context->fixups != NULL) {
+        clearFixupList(context->fixups);
+    }
+    freeObjectModule(&context->module);
+    context->program.count = 0;
+}
+
+/* Frees the tables, after an allocation failure that may have left one half grown. */
+static void freeSourceTables(assemblerContext *context) {
+    if (context->macros != NULL) {
+        freeMacros(context->macros);
+        context->macros = NULL;
+    }
+    if (context->symTable != NULL) {
+        freeSymbolTable(context->symTable);
+        context->symTable = NULL;
+    }
+    freeInstructionList(context->instructions);
+    context->instructions = NULL;
+    freeCodeSegment(context->code);
+    context->code = NULL;
+    freeDataSegment(context->data);
+    context->data = NULL;
+    if (context->fixups != NULL) {
+        freeFixupList(context->fixups);
+        context->fixups = NULL;
+    }
+    freeTokenStream(&context->tokens);
+    freeObjectModule(&context->module);
+    context->program.count = 0;
+}
+
+/* Assembles a source held in memory. */
+assemblyResult *assembleBuffer(assemblerContext *context, const char *source, long length,
+                               const assemblerOptions *options) {
+    assemblyResult *result = &context->result;
+    int IC = INITIAL_IC, DC = INITIAL_DC;
+    sourceBuffer text;
+    jmp_buf *previous;
+    double start;
+
+    /* Empty the buffers of the last source, keeping their memory */
+    result->output.object.length = result->output.entries.length = 0;
+    result->output.externals.length = result->output.relocations.length = result->output.lineMap.length = 0;
+    result->expanded.length = 0;
+    result->diagnostics.count = result->diagnostics.errors = 0;
+    result->diagnostics.line = 0;
+    initStats(&result->stats);
+
+    /* The source is only read; it is neither mapped nor owned here */
+    text.text = (char *) source;
+    text.length = length;
+    text.mapped = false;
+
+    /* An allocation failure anywhere below comes back here */
+    previous = setAllocationHandler(&context->onFailure);
+    if (setjmp(context->onFailure) != 0) {
+        freeSourceTables(context);
+        result->output.object.length = result->output.entries.length = 0;
+        result->output.externals.length = result->output.relocations.length = result->output.lineMap.length = 0;
+        result->expanded.length = 0;
+        result->status = ASSEMBLY_OUT_OF_MEMORY;
+        setAllocationHandler(previous);
+        return result;
+    }
+
+    /* A source assembled before has its files restored, without expanding or assembling it */
+    if (options->cacheDirectory != NULL) {
+        start = currentTime();
+        result->stats.cacheStatus = loadCacheEntry(options->cacheDirectory, source, length, options,
+                                                   &result->output, &result->expanded);
+        if (result->stats.cacheStatus == CACHE_HIT) {
+            result->stats.bytesWritten = result->output.object.length + result->output.entries.length +
+                                         result->output.externals.length + result->output.relocations.length +
+                                         result->output.lineMap.length;
+            result->stats.outputTime = currentTime() - start;
+            result->status = ASSEMBLY_SUCCESS;
+            setAllocationHandler(previous);
+            return result;
+        }
+    }
+
+    /* Expand macros, keeping the text of the .am file only on request; their names go to the pool of the symbols */
+    if (context->symTable == NULL) {
+        context->symTable = initSymbolTable();
+    }
+    if (context->macros == NULL) {
+        context->macros = initMacroTable(context->symTable->names);
+    }
+    context->program.expandedText = options->keepExpandedFile ? &result->expanded : NULL;
+    start = currentTime();
+    if (!expandMacros(&text, &context->tokens, context->macros, collectExpandedLine, &context->program,
+                      &result->stats, &result->diagnostics)) {
+        result->expanded.length = 0;
+        result->status = ASSEMBLY_EXPANSION_FAILED;
+    } else {
+        result->stats.expandTime = currentTime() - start;
+
+        /* Initialize the segments, unless the last source left them */
+        if (context->instructions == NULL) {
+            context->instructions = initInstructionList();
+        }
+        if (context->code == NULL) {
+            context->code = initCodeSegment();
+        }
+        if (context->data == NULL) {
+            context->data = initDataSegment();
+        }
+        if (context->fixups == NULL) {
+            context->fixups = initFixupList();
+        }
+        context->code->keepLines = options->writeLineMap;
+
+        /* Perform the assembler pass, then encode the instructions it collected */
+        start = currentTime();
+        firstAssemblerPass(&context->program, context->symTable, context->instructions, context->data,
+                           context->fixups, &result->diagnostics, &IC, &DC);
+        encodeInstructions(context->instructions, context->code);
+        result->stats.firstPassTime = currentTime() - start;
+
+        /* Resolve the forward references */
+        start = currentTime();
+        resolveFixups(context->fixups, context->symTable, context->code, &result->diagnostics);
+        result->stats.resolveTime = currentTime() - start;
+
+        /* Format the output files */
+        start = currentTime();
+        buildObjectModule(context->code, context->data, IC, context->symTable, context->fixups, &context->module);
+        result->stats.bytesWritten = formatObjectBuffers(&context->module, options, &result->output);
+        result->stats.outputTime = currentTime() - start;
+
+        result->stats.symbolsAdded = context->symTable->count;
+        result->stats.symbolLookups = context->symTable->lookups;
+        result->stats.wordsEmitted = context->code->count + context->data->count;
+        result->status = result->diagnostics.errors > 0 ? ASSEMBLY_ERRORS : ASSEMBLY_SUCCESS;
+
+        /* Only sources without errors or warnings are cached, their messages are reported by assembling them again */
+        if (options->cacheDirectory != NULL && result->diagnostics.count == 0) {
+            storeCacheEntry(options->cacheDirectory, source, length, options, &result->output, &result->expanded);
+        }
+    }
+
+    clearSourceTables(context);
+    setAllocationHandler(previous);
+    return result;
+}
+
+/* Writes the files of a result in place of the extension of a file name. */
+long writeAssemblyFiles(char *fileName, assemblyResult *result, const assemblerOptions *options) {
+    char *expandedFileName;
+    long bytes = 0;
+    double start;
+
+    if (options->keepExpandedFile) {
+        expandedFileName = changeFileExtension(fileName, ".am");
+        bytes = writeOutputBuffer(expandedFileName, &result->expanded);
+        free(expandedFileName);
+    }
+
+    /* Writing the files is part of the output stage */
+    start = currentTime();
+    if (bytes >= 0) {
+        bytes = createOutputFiles(fileName, &result->output);
+    }
+    result->stats.outputTime += currentTime() - start;
+    return bytes;
+}
+
+/* Frees a context and its last result. */
+void freeAssemblerContext(assemblerContext *context) {
+    freeSourceTables(context);
+    freeExpandedProgram(&context->program);
+    freeObjectBuffers(&context->result.output);
+    freeByteBuffer(&context->result.expanded);
+    freeDiagnostics(&context->result.diagnostics);
+    free(context);
+}
@@ -0,0 +1,80 @@
+#ifndef LIBASSEMBLER_H
+#define LIBASSEMBLER_H
+
+#include "assembler.h"
+#include "byteBuffer.h"
+#include "diagnostics.h"
+#include "outputFiles.h"
+#include "statistics.h"
+
+/* Outcome of assembling a source */
+#define ASSEMBLY_SUCCESS 0          /* The output files are ready */
+#define ASSEMBLY_ERRORS 1           /* Errors were reported; the output files are still formatted */
+#define ASSEMBLY_EXPANSION_FAILED 2 /* The macros could not be expanded, there are no output files */
+#define ASSEMBLY_OUT_OF_MEMORY 3    /* Memory ran out, there are no output files */
+
+/* Structure holding everything assembling one source produces. */
+typedef struct {
+    int status;                   /* One of the ASSEMBLY_ outcomes */
+    objectBuffers output;         /* The object files, with the .rel and .map files on request */
+    byteBuffer expanded;          /* The text of the .am file, when keepExpandedFile is set */
+    diagnosticList diagnostics;   /* The errors and the warnings found in the source */
+    assemblerStats stats;         /* The timing and counters of the source */
+} assemblyResult;
+
+/* The state of the assembler, one per thread assembling sources. */
+typedef struct assemblerContext assemblerContext;
+
+/*
+ * Creates an assembler context.
+ *
+ * A context holds no state shared with other contexts, so each thread may assemble
+ * with its own. The buffers of a context are reused by every source it assembles.
+ *
+ * @return The new context, or NULL if there is not enough memory.
+ */
+assemblerContext *initAssemblerContext();
+
+/*
+ * Assembles a source held in memory.
+ *
+ * The source is read in place and does not have to be null terminated. Nothing is
+ * written to the standard streams, and no file is written besides the entries of the
+ * cache: the output files, the expanded source and the messages are all returned in the
+ * result. Running out of memory does not end the process; it is reported in the status
+ * of the result.
+ *
+ * With a cache directory, a source that assembled without any message before has its files
+ * restored from the cache (see cache.h), and the result tells whether it was.
+ *
+ * @param context The context to assemble with.
+ * @param source The text of the source.
+ * @param length The number of characters in the source.
+ * @param options The options; keepExpandedFile, objectFormat, writeRelocations, writeLineMap and
+ *                cacheDirectory are used.
+ * @return The result, owned by the context and valid until its next assembly.
+ */
+assemblyResult *assembleBuffer(assemblerContext *context, const char *source, long length,
+                               const assemblerOptions *options);
+
+/*
+ * Writes the files of a result in place of the extension of a file name.
+ *
+ * The .am file is written when options->keepExpandedFile is set, then the object files.
+ * The time spent is added to the output time of the result.
+ *
+ * @param fileName The name whose extension is replaced, usually the name of the source.
+ * @param result A result with the status ASSEMBLY_SUCCESS or ASSEMBLY_ERRORS.
+ * @param options The options the result was assembled with.
+ * @return The number of bytes of the object files, -1 if a file could not be written.
+ */
+long writeAssemblyFiles(char *fileName, assemblyResult *result, const assemblerOptions *options);
+
+/*
+ * Frees a context and its last result.
+ *
+ * @param context The context to free.
+ */
+void freeAssemblerContext(assemblerContext *context);
+
+#endif
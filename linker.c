@@ -0,0 +1,311 @@
+/*
+ * linker.c
+ *
+ * Description:
+ * Links the object files of a program split into modules into one image.
+ * The code words of all the modules come first, in the order of the
+ * command line, then their data words. The entries of every module form
+ * one export table; each word a module marks as external (listed in its
+ * .ext file) is patched with the address of the export of that name, and
+ * each relocatable word is moved by the new address of the module. Every
+ * word and every symbol is visited a fixed number of times, so linking
+ * takes time linear in the size of the modules.
+ *
+ * Usage:
+ *   ./linker -o prog main.ob util.ob          writes prog.ob and prog.ent
+ *   ./linker --format=bin -o prog main.bin    writes prog.bin
+ *   ./linker --rel -o prog main.ob util.ob    also writes prog.rel, see ./rebase
+ * A module is read from its .ob, .ent and .ext files, or from its binary
+ * object file when its name ends with .bin.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "assembler.h"
+#include "machineCode.h"
+#include "objectFile.h"
+#include "outputFiles.h"
+#include "stringPool.h"
+
+/* Structure representing a module being linked. */
+typedef struct {
+    const char *fileName;     /* The object file the module was read from */
+    objectModule module;      /* The words and the symbols of the module */
+    int codeStart;            /* Address of the first code word of the module in the image */
+    int dataStart;            /* Address of the first data word of the module in the image */
+} linkedModule;
+
+/* Structure representing the symbols exported by the entries of all the modules. */
+typedef struct {
+    stringPool *names;        /* The names of the exports, interned */
+    int *addresses;           /* Address of each export in the image, by name ID */
+    int *modules;             /* Module exporting each name, by name ID */
+    int capacity;             /* Number of names the arrays can hold */
+} exportTable;
+
+/*
+ * Moves an address of a module to the image.
+ * @param linked The module.
+ * @param address An address of the module, in its code or its data.
+ * @return The address in the image, or -1 if the address is outside the module.
+ */
+static int relocateAddress(linkedModule *linked, int address) {
+    objectModule *module = &linked->module;
+
+    if (address >= module->loadBase && address < module->dataBase) {
+        return address - module->loadBase + linked->codeStart;
+    }
+    /* The end of the data is the address of a label after the last word */
+    if (address >= module->dataBase && address <= module->dataBase + module->dataCount) {
+        return address - module->dataBase + linked->dataStart;
+    }
+    return -1;
+}
+
+/*
+ * Adds the entries of a module to the export table, at their addresses in the image.
+ * @param exports The export table.
+ * @param modules All the modules.
+ * @param index The number of the module.
+ * @return The number of errors found.
+ */
+static int addExports(exportTable *exports, linkedModule *modules, int index) {
+    objectModule *module = &modules[index].module;
+    objectSymbol *entry;
+    span name;
+    int i, id, known, address, errors = 0;
+
+    for (i = 0; i < module->entryCount; i++) {
+        entry = &module->entries[i];
+        name.start = entry->name;
+        name.length = (int) strlen(entry->name);
+        known = exports->names->count;
+        id = internString(exports->names, name);
+
+        /* The arrays grow with the pool, a new name is not exported yet */
+        if (id == known) {
+            if (id == exports->capacity) {
+                exports->capacity = exports->capacity ? 2 * exports->capacity : INITIAL_POOL_STRINGS;
+                exports->addresses = reallocateMemory(exports->addresses, exports->capacity * sizeof(int));
+                exports->modules = reallocateMemory(exports->modules, exports->capacity * sizeof(int));
+            }
+            exports->modules[id] = -1;
+        }
+
+        address = relocateAddress(&modules[index], entry->address);
+        if (address < 0) {
+            fprintf(stderr, "Error: Entry %s of %s is outside the module\n", entry->name, modules[index].fileName);
+            errors++;
+        } else if (exports->modules[id] >= 0) {
+            fprintf(stderr, "Error: Symbol %s is exported by both %s and %s\n", entry->name,
+                    modules[exports->modules[id]].fileName, modules[index].fileName);
+            errors++;
+        } else {
+            exports->addresses[id] = address;
+            exports->modules[id] = index;
+        }
+    }
+    return errors;
+}
+
+/*
+ * Copies the words of a module into the image, relocating and patching its references.
+ * @param exports The export table of all the modules.
+ * @param linked The module.
+ * @param image The image, whose words are laid out already.
+ * @return The number of errors found.
+ */
+static int linkModule(exportTable *exports, linkedModule *linked, objectModule *image) {
+    objectModule *module = &linked->module;
+    unsigned short *code = image->code + (linked->codeStart - image->loadBase);
+    objectSymbol *reference;
+    span name;
+    int i, id, site, address, errors = 0;
+
+    /* Only code words carry the A, R and E bits, data words are plain values */
+    memcpy(code, module->code, module->codeCount * sizeof(unsigned short));
+    memcpy(image->data + (linked->dataStart - image->dataBase), module->data, module->dataCount * sizeof(unsigned short));
+
+    for (i = 0; i < module->codeCount; i++) {
+        if ((code[i] & ARE_MASK) == (1 << R_BIT)) {
+            address = relocateAddress(linked, code[i] >> VAL_POSITION);
+            if (address < 0) {
+                fprintf(stderr, "Error: Word %d of %s refers outside the module\n", module->loadBase + i, linked->fileName);
+                errors++;
+            } else if (address >= LABEL_ADDRESS_SPAN) {
+                fprintf(stderr, "Error: Word %d of %s refers to address %d, outside the %d addresses of a word\n",
+                        module->loadBase + i, linked->fileName, address, LABEL_ADDRESS_SPAN);
+                errors++;
+            } else {
+                code[i] = (unsigned short) ((address << VAL_POSITION) | (1 << R_BIT));
+            }
+        }
+    }
+
+    /* The external words become relocatable words holding the address of the export */
+    for (i = 0; i < module->externCount; i++) {
+        reference = &module->externs[i];
+        name.start = reference->name;
+        name.length = (int) strlen(reference->name);
+        id = findString(exports->names, name);
+        site = reference->address - module->loadBase;
+
+        if (site < 0 || site >= module->codeCount || (module->code[site] & ARE_MASK) != (1 << E_BIT)) {
+            fprintf(stderr, "Error: Reference to %s at %d of %s is not an external word\n", reference->name,
+                    reference->address, linked->fileName);
+            errors++;
+        } else if (id == NO_STRING || exports->modules[id] < 0) {
+            fprintf(stderr, "Error: Undefined external symbol %s in %s\n", reference->name, linked->fileName);
+            errors++;
+        } else if (exports->addresses[id] >= LABEL_ADDRESS_SPAN) {
+            fprintf(stderr, "Error: Symbol %s referred to at %d of %s is at address %d, outside the %d addresses of a word\n",
+                    reference->name, reference->address, linked->fileName, exports->addresses[id], LABEL_ADDRESS_SPAN);
+            errors++;
+        } else {
+            address = exports->addresses[id];
+            code[site] = (unsigned short) ((address << VAL_POSITION) | (1 << R_BIT));
+        }
+    }
+    return errors;
+}
+
+/*
+ * Links the modules into one image.
+ * @param modules The modules, in the order of their code and data in the image.
+ * @param count The number of modules.
+ * @param image Receives the image; its entries are the exports of all the modules.
+ * @return The number of errors found; the image is only complete without errors.
+ */
+static int linkModules(linkedModule *modules, int count, objectModule *image) {
+    exportTable exports;
+    long codeCount = 0, dataCount = 0;
+    int i, id, errors = 0;
+
+    /* Lay out the code of every module, then the data of every module */
+    for (i = 0; i < count; i++) {
+        modules[i].codeStart = INITIAL_IC + (int) codeCount;
+        codeCount += modules[i].module.codeCount;
+    }
+    for (i = 0; i < count; i++) {
+        modules[i].dataStart = INITIAL_IC + (int) (codeCount + dataCount);
+        dataCount += modules[i].module.dataCount;
+    }
+
+    /* Every word of the image must have an address a word can hold */
+    initObjectModule(image);
+    if (INITIAL_IC + codeCount + dataCount > LABEL_ADDRESS_SPAN) {
+        fprintf(stderr, "Error: The image of %ld words does not fit in the %d addresses of a word\n",
+                codeCount + dataCount, LABEL_ADDRESS_SPAN);
+        return 1;
+    }
+    image->ownsWords = true;
+    image->codeCount = (int) codeCount;
+    image->dataCount = (int) dataCount;
+    image->loadBase = INITIAL_IC;
+    image->dataBase = INITIAL_IC + (int) codeCount;
+    image->code = allocateMemory((codeCount > 0 ? codeCount : 1) * sizeof(unsigned short));
+    image->data = allocateMemory((dataCount > 0 ? dataCount : 1) * sizeof(unsigned short));
+
+    /* Every export is known before the first reference is patched */
+    exports.names = initStringPool();
+    exports.addresses = NULL;
+    exports.modules = NULL;
+    exports.capacity = 0;
+    for (i = 0; i < count; i++) {
+        errors += addExports(&exports, modules, i);
+    }
+    for (i = 0; i < count; i++) {
+        errors += linkModule(&exports, &modules[i], image);
+    }
+
+    /* The image exports the entries of all its modules, in the order they were first declared */
+    for (id = 0; id < exports.names->count; id++) {
+        if (exports.modules[id] >= 0) {
+            addObjectSymbol(image, ENTRY_TABLE, poolString(exports.names, id), poolStringLength(exports.names, id),
+                            exports.addresses[id]);
+        }
+    }
+
+    freeStringPool(exports.names);
+    free(exports.addresses);
+    free(exports.modules);
+    return errors;
+}
+
+/*
+ * Main function of the linker.
+ * @param argc The number of command-line arguments.
+ * @param argv The options, the output name and the modules to link.
+ * @return 0 if the image was written, otherwise 1.
+ */
+int main(int argc, char *argv[]) {
+    linkedModule *modules;
+    objectModule image;
+    char *outputName = NULL, *fileName;
+    int i, first = 1, count, format = FORMAT_TEXT, errors = 0;
+    bool relocations = false;
+    long bytes;
+
+    /* Parse the options given before the file names */
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "--format=text") == 0) {
+            format = FORMAT_TEXT;
+        } else if (strcmp(argv[first], "--format=bin") == 0) {
+            format = FORMAT_BINARY;
+        } else if (strcmp(argv[first], "--rel") == 0) {
+            relocations = true;
+        } else if (strcmp(argv[first], "-o") == 0 && first + 1 < argc) {
+            outputName = argv[++first];
+        } else {
+            printf("Unknown option: %s\n", argv[first]);
+            return 1;
+        }
+        first++;
+    }
+
+    if (outputName == NULL || argc - first < 1) {
+        printf("Usage: %s [--format=text|bin] [--rel] -o <output> <module 1> [<module 2> ...]\n", argv[0]);
+        return 1;
+    }
+
+    count = argc - first;
+    modules = allocateMemory(count * sizeof(linkedModule));
+    for (i = 0; i < count; i++) {
+        modules[i].fileName = argv[first + i];
+        if (!readObjectModule(modules[i].fileName, &modules[i].module)) {
+            fprintf(stderr, "Error reading module: %s\n", modules[i].fileName);
+            while (i-- > 0) {
+                freeObjectModule(&modules[i].module);
+            }
+            free(modules);
+            return 1;
+        }
+    }
+
+    errors = linkModules(modules, count, &image);
+    if (errors == 0) {
+        if (format == FORMAT_BINARY) {
+            fileName = changeFileExtension(outputName, BINARY_OBJECT_EXTENSION);
+            bytes = writeBinaryObject(fileName, &image);
+            free(fileName);
+        } else {
+            bytes = createTextObjectFiles(outputName, &image);
+        }
+        if (bytes >= 0 && relocations) {
+            fileName = changeFileExtension(outputName, ".rel");
+            bytes = createRelocationFile(fileName, &image);
+            free(fileName);
+        }
+        errors = bytes < 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        freeObjectModule(&modules[i].module);
+    }
+    freeObjectModule(&image);
+    free(modules);
+    return errors > 0 ? 1 : 0;
+}
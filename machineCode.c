@@ -2,6 +2,7 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "keywords.h"
 #include "machineCode.h"
 #include "processorUtils.h"
 #include "symbolTable.h"
@@ -22,27 +23,26 @@ unsigned short word15bits(unsigned short line) {
  * Convert a string representation of a number to an unifned short,
  * handling multiple digits and a leading minus sign
  */
-unsigned short convertStringToShort(const char *str) {
+unsigned short convertStringToShort(span str) {
     unsigned short result = 0;
-    int sign = 1;
+    int sign = 1, i = 0;
 
     /* Skip non-digit and non-minus characters */
-    while (*str && !isdigit(*str) && *str != '-') {
-        str++;
+    while (i < str.length && !isdigit((unsigned char) str.start[i]) && str.start[i] != '-') {
+        i++;
     }
 
     /* Check if the number is negative */
-    if (*str == '-') {
+    if (i < str.length && str.start[i] == '-') {
         sign = -1;
-        str++;
+        i++;
     }
 
     /* Convert each digit to the corresponding integer value */
-    while (*str) {
-        if (isdigit(*str)) {
-            result = result * 10 + (*str - '0');
+    for (; i < str.length; i++) {
+        if (isdigit((unsigned char) str.start[i])) {
+            result = result * 10 + (str.start[i] - '0');
         }
-        str++;
     }
     return result * sign;
 }
@@ -57,78 +57,15 @@ unsigned short shiftBits(unsigned short line, int position) {
     return line << (position);
 }
 
-/* Retrieves the opcode value corresponding to a given operation name. */
-unsigned short getOpCode(const char *name) {
-    unsigned short code = OPERATIONS+1; /* Invalid value to validate return value */
-
-    if (strcmp(name, "mov") == 0) { code = 0; } else if (strcmp(name, "cmp") == 0) { code = 1; } else if (
-        strcmp(name, "add") == 0) { code = 2; } else if (strcmp(name, "sub") == 0) { code = 3; } else if (
-        strcmp(name, "lea") == 0) { code = 4; } else if (strcmp(name, "clr") == 0) { code = 5; } else if (
-        strcmp(name, "not") == 0) { code = 6; } else if (strcmp(name, "inc") == 0) { code = 7; } else if (
-        strcmp(name, "dec") == 0) { code = 8; } else if (strcmp(name, "jmp") == 0) { code = 9; } else if (
-        strcmp(name, "bne") == 0) { code = 10; } else if (strcmp(name, "red") == 0) { code = 11; } else if (
-        strcmp(name, "prn") == 0) { code = 12; } else if (strcmp(name, "jsr") == 0) { code = 13; } else if (
-        strcmp(name, "rts") == 0) { code = 14; } else if (strcmp(name, "stop") == 0) { code = 15; }
-
-    if (code > OPERATIONS) {
-        fprintf(stderr, "Error - invalid opcode name\n");
-    }
-    code <<= OP_C_POSITION;
-    return code;
-}
-
-
-/* Writes a register operand value, adjusting bit positions for source or destination. */
-unsigned short writeRegister(char *operand, int isSource) {
-    unsigned short line = convertStringToShort(operand);
-
-    if (isSource) {
-        line = shiftBits(line, S_REG_POSITION);
-    } else {
-        line = shiftBits(line, D_REG_POSITION);
-    }
-    line |= setBit(A_BIT);
-    return line;
-}
-
-/* Writes an operand line based on its addressing mode. */
-unsigned short writeOperandLine(char *operand, int mode, int sourceFlag) {
-    unsigned short line = 0;
-
-    /* For DIRECT mode, the value will be resolved in the second pass */
-    if (mode == DIRECT) {
-        return line;
-    }
-    if (mode == INDIRECT_REG || mode == DIRECT_REG) {
-        line = convertStringToShort(operand);
-        if (sourceFlag) {
-            line = shiftBits(line, S_REG_POSITION);
-        } else {
-            line = shiftBits(line, D_REG_POSITION);
-        }
-    } else if (mode == IMMEDIATE) {
-        line = convertStringToShort(operand); /* Skip the '#' character */
-        line = shiftBits(line, VAL_POSITION);
-    }
-    line |= setBit(A_BIT);
-    line = word15bits(line);
-    return line;
+/* Retrieves the opcode value corresponding to a given operation. */
+unsigned short getOpCode(int id) {
+    return (unsigned short) (id << OP_C_POSITION);
 }
 
-/* Determines the addressing mode of an operand. */
-int addressingMode(char *operand) {
-    if (operand == NULL) {
-        return -1;
-    }
-    if (*operand == '#') { return IMMEDIATE; }
-    if (isInDirectRegister(operand)) { return INDIRECT_REG; }
-    if (isDirectRegister(operand)) { return DIRECT_REG; }
-    return DIRECT; /* Operand already validated - must be symbol */
-}
 
 /* Creates the binary representation of an instruction line. */
-unsigned short writeOpCode(char *operation, int sourceMode, int destMode) {
-    unsigned short line = getOpCode(operation);
+unsigned short writeOpCode(int opcode, int sourceMode, int destMode) {
+    unsigned short line = getOpCode(opcode);
 
     if (sourceMode >= 0) {
         line |= setBit(S_POSITION + sourceMode);
@@ -142,47 +79,91 @@ unsigned short writeOpCode(char *operation, int sourceMode, int destMode) {
     return line;
 }
 
-/* Adds an instruction line to the instruction list. */
-void addInstructionLine(char *operation, char *sourceOperand, char *destOperand, int IC, instructionList **tail) {
-    int sourceMode, destMode;
-    unsigned short line = 0;
-
-    sourceMode = addressingMode(sourceOperand);
-    destMode = addressingMode(destOperand);
+/* Classifies an operand of an instruction and stores its addressing mode and its value. */
+void parseOperand(span operand, symbolTable *symTable, instruction *in, int flag) {
+    span name = operand;
+    int id;
 
-    line = writeOpCode(operation, sourceMode, destMode);
-    addToInstructionList(tail, NULL, IC, line);
+    if (operand.start == NULL) {
+        in->modes[flag] = NO_OPERAND;
+        in->values[flag] = 0;
+        return;
+    }
+    if (*operand.start == '#') {
+        in->modes[flag] = IMMEDIATE;
+        in->values[flag] = convertStringToShort(operand);
+        return;
+    }
 
-    if (sourceOperand != NULL) {
-        if (isRegister(sourceOperand) && isRegister(destOperand)) {
-            line = writeRegister(sourceOperand, SOURCE_FLAG);
-            line |= writeRegister(destOperand, DEST_FLAG);
+    /* A register is looked up once, with or without its '*' */
+    if (*name.start == '*') {
+        name.start++;
+        name.length--;
+    }
+    id = keywordOf(name);
+    if (IS_REGISTER(id)) {
+        in->modes[flag] = name.start != operand.start ? INDIRECT_REG : DIRECT_REG;
+        in->values[flag] = REGISTER_NUMBER(id);
+    } else {
+        in->modes[flag] = DIRECT; /* Operand already validated - must be symbol */
+        in->values[flag] = internName(symTable, operand);
+    }
+}
 
-            addToInstructionList(tail, NULL, ++IC, line);
-        } else {
-            line = writeOperandLine(sourceOperand, sourceMode, SOURCE_FLAG);
+/* Returns the number of words of an instruction. */
+int instructionLength(const instruction *in) {
+    if (IS_REGISTER_MODE(in->modes[SOURCE_FLAG]) && IS_REGISTER_MODE(in->modes[DEST_FLAG])) {
+        return 2;
+    }
+    return 1 + (in->modes[SOURCE_FLAG] != NO_OPERAND) + (in->modes[DEST_FLAG] != NO_OPERAND);
+}
 
-            if (sourceMode != DIRECT) { sourceOperand = NULL; }
-            addToInstructionList(tail, sourceOperand, ++IC, line);
+/* Writes the word of an operand, the address of a symbol is written when the fixups are resolved. */
+static unsigned short writeOperandWord(int mode, int value, int flag) {
+    unsigned short line;
 
-            line = writeOperandLine(destOperand, destMode, DEST_FLAG);
+    if (mode == DIRECT) {
+        return 0;
+    }
+    if (mode == IMMEDIATE) {
+        line = shiftBits((unsigned short) value, VAL_POSITION);
+    } else {
+        line = shiftBits((unsigned short) value, flag == SOURCE_FLAG ? S_REG_POSITION : D_REG_POSITION);
+    }
+    return word15bits(line | setBit(A_BIT));
+}
 
-            if (destMode != DIRECT) { destOperand = NULL; }
-            addToInstructionList(tail, destOperand, ++IC, line);
+/* Turns the instructions into words, appended to the code segment. */
+void encodeInstructions(instructionList *instructions, codeSegment *code) {
+    const instruction *in = instructions->items, *end = in + instructions->count;
+    int flag;
+
+    for (; in < end; in++) {
+        code->line = in->line;
+        addToCodeSegment(code, NO_STRING, writeOpCode(in->opcode, in->modes[SOURCE_FLAG], in->modes[DEST_FLAG]));
+
+        /* Two register operands share one word */
+        if (IS_REGISTER_MODE(in->modes[SOURCE_FLAG]) && IS_REGISTER_MODE(in->modes[DEST_FLAG])) {
+            addToCodeSegment(code, NO_STRING,
+                             writeOperandWord(in->modes[SOURCE_FLAG], in->values[SOURCE_FLAG], SOURCE_FLAG) |
+                             writeOperandWord(in->modes[DEST_FLAG], in->values[DEST_FLAG], DEST_FLAG));
+            continue;
+        }
+        for (flag = SOURCE_FLAG; flag >= DEST_FLAG; flag--) {
+            if (in->modes[flag] != NO_OPERAND) {
+                addToCodeSegment(code, in->modes[flag] == DIRECT ? in->values[flag] : NO_STRING,
+                                 writeOperandWord(in->modes[flag], in->values[flag], flag));
+            }
         }
-    } else if (destOperand != NULL) {
-        line = writeOperandLine(destOperand, destMode, DEST_FLAG);
-        if (destMode != DIRECT) { destOperand = NULL; }
-        addToInstructionList(tail, destOperand, ++IC, line);
     }
 }
 
 /* Writes the address of a label into a binary instruction. */
-unsigned short writeLabelAddress(Symbol *symbol) {
+unsigned short writeLabelAddress(symbolTable *symTable, Symbol *symbol) {
     unsigned short line;
-    line = (unsigned short) symbol->address;
+    line = (unsigned short) symbolAddress(symTable, symbol);
     line = shiftBits(line, VAL_POSITION);
-    if (strcmp(symbol->type, "external") == 0) {
+    if (symbol->flags & SYMBOL_EXTERNAL) {
         line |= setBit(E_BIT);
     } else {
         line |= setBit(R_BIT);
@@ -1,6 +1,8 @@
 #ifndef MACHINE_CODE_H
 #define MACHINE_CODE_H
 
+#include "header.h"
+#include "instructionList.h"
 #include "memory.h"
 #include "symbolTable.h"
 
@@ -10,6 +12,8 @@
 #define INDIRECT_REG 2
 #define DIRECT_REG 3
 
+#define IS_REGISTER_MODE(mode) ((mode) >= INDIRECT_REG)
+
 /* Bit positions in the instruction word */
 #define S_POSITION 7
 #define D_POSITION 3
@@ -23,34 +27,66 @@
 #define E_BIT 0
 #define R_BIT 1
 #define A_BIT 2
+#define ARE_MASK 7                /* The A, R and E bits of a word */
+#define ADDRESS_MASK 0xFFF        /* The 12 bits of a value in a 15 bit word, above the A, R and E bits */
+
+/*
+ * Width of the address in a word that holds the address of a label. The assembler writes it
+ * above the A, R and E bits up to the sixteenth bit of the word, so the object files carry
+ * 13 bits; the linker and the rebase tool refuse an address that does not fit.
+ */
+#define LABEL_ADDRESS_BITS 13
+#define LABEL_ADDRESS_SPAN (1 << LABEL_ADDRESS_BITS)
 
 /* Operand flags */
 #define SOURCE_FLAG 1
 #define DEST_FLAG 0
 
 /*
- * Adds an instruction line to the instruction list.
+ * Classifies an operand of an instruction.
+ *
+ * The addressing mode and the value of the operand are stored in the instruction: the number
+ * of a register, the value of an immediate operand, or the ID of a symbol operand, whose name
+ * is interned in the symbol table's string pool. The operand is not read again after this.
+ *
+ * @param operand The operand, already validated, or a NULL start if the instruction has none.
+ * @param symTable The symbol table whose string pool holds the symbol operands.
+ * @param in The instruction receiving the operand.
+ * @param flag SOURCE_FLAG or DEST_FLAG.
+ */
+void parseOperand(span operand, symbolTable *symTable, instruction *in, int flag);
+
+/*
+ * Returns the number of words an instruction is encoded in.
+ *
+ * @param in The instruction, with its operands classified.
+ * @return The number of words, from 1 to 3.
+ */
+int instructionLength(const instruction *in);
+
+/*
+ * Encodes instructions into the code segment.
  *
- * This function processes an instruction, including its operation and operands, and adds
- * it to the provided instruction list. It also updates the instruction counter.
+ * Every instruction is turned into its words, which are appended to the code segment in one
+ * loop over the list. The words of symbol operands are recorded by ID in the segment's reference
+ * table and hold their address once the fixups are resolved. The source line of each instruction
+ * goes to the line records of the segment.
  *
- * @param operation The name of the operation (e.g., "mov", "add").
- * @param sourceOperand The source operand for the instruction, if any.
- * @param destOperand The destination operand for the instruction, if any.
- * @param IC The current instruction counter value.
- * @param tail A pointer to the pointer of the last node in the instruction list. This will be updated to point to the newly added node.
+ * @param instructions The instructions the first pass produced.
+ * @param code The code segment the words are appended to.
  */
-void addInstructionLine(char *operation, char *sourceOperand, char *destOperand, int IC, instructionList **tail);
+void encodeInstructions(instructionList *instructions, codeSegment *code);
 
 /*
  * Writes the address of a symbol to a 15-bit word.
  *
  * This function converts a symbol's address into a 15-bit representation suitable for machine code.
  *
+ * @param symTable The symbol table, which relocates data symbols.
  * @param symbol The symbol whose address is to be written.
  * @return The 15-bit address of the symbol.
  */
-unsigned short writeLabelAddress(Symbol *symbol);
+unsigned short writeLabelAddress(symbolTable *symTable, Symbol *symbol);
 
 /*
  * Converts a line to a 15-bit word representation.
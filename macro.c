@@ -1,96 +1,109 @@
 #include "stdlib.h"
 #include <stdio.h>
 #include <string.h>
+#include "allocation.h"
 #include "macro.h"
 
 #include "header.h"
+#include "keywords.h"
+#include "processorUtils.h"
 
 
-/* Adds a new macro to the macro list */
-void addMacro(macro **head, char *name) {
-    macro *newMacro = malloc(sizeof(macro));
-    if (newMacro == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
-    }
+/* Initializes an empty macro table */
+macroTable *initMacroTable(stringPool *names) {
+    macroTable *table = allocateMemory(sizeof(macroTable));
+
+    table->names = names;
+    table->byName = NULL;
+    table->byNameCapacity = 0;
+    table->count = 0;
+    return table;
+}
+
+/* Frees a macro and its array of lines */
+static void freeMacro(macro *macro) {
+    free(macro->lines);
+    free(macro);
+}
+
+/* Adds a new macro to the macro table */
+macro *addMacro(macroTable *table, span name) {
+    int id, i;
+    macro *newMacro;
 
-    /* Allocate memory for the macro name */
-    newMacro->name = malloc(strlen(name) + 1);
-    if (newMacro->name == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed for macro name.\n");
-        free(newMacro);  /* Free previously allocated memory */
-        exit(EXIT_FAILURE);
+    /* Every name ID has a slot in the array of macros */
+    id = internString(table->names, name);
+    if (id >= table->byNameCapacity) {
+        int capacity = table->names->capacity;
+        table->byName = reallocateMemory(table->byName, capacity * sizeof(macro *));
+        for (i = table->byNameCapacity; i < capacity; i++) {
+            table->byName[i] = NULL;
+        }
+        table->byNameCapacity = capacity;
     }
 
-    /* Copy the name into the newly allocated memory */
-    strcpy(newMacro->name, name);
+    newMacro = allocateMemory(sizeof(macro));
+    newMacro->nameId = id;
     newMacro->lines = NULL;
     newMacro->lineCount = 0;
-    newMacro->next = *head;
-    *head = newMacro;
-}
+    newMacro->lineCapacity = 0;
 
-/* Add a line to a macro's lines list */
-void addMacroLine(macro *macro, char *line) {
-    macro->lines = realloc(macro->lines, sizeof(char *) * (macro->lineCount + 1));
-    if (macro->lines == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed for macro lines.\n");
-        exit(EXIT_FAILURE);
+    /* A redefinition hides the previous macro */
+    if (table->byName[id] != NULL) {
+        freeMacro(table->byName[id]);
     }
+    table->byName[id] = newMacro;
+    table->count++;
+    return newMacro;
+}
 
-    macro->lines[macro->lineCount] = malloc(strlen(line) + 1);
-    if (macro->lines[macro->lineCount] == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed for macro line.\n");
-        exit(EXIT_FAILURE);
+/* Add a line to a macro's lines list */
+void addMacroLine(macro *macro, int line) {
+    /* Grow the array of lines geometrically */
+    if (macro->lineCount == macro->lineCapacity) {
+        macro->lineCapacity = macro->lineCapacity ? 2 * macro->lineCapacity : INITIAL_MACRO_LINES;
+        macro->lines = reallocateMemory(macro->lines, sizeof(int) * macro->lineCapacity);
     }
 
-    strcpy(macro->lines[macro->lineCount], line);
-    macro->lineCount++;
+    macro->lines[macro->lineCount++] = line;
 }
 
-/* Finds a macro by its name in the list */
-macro *findMacro(macro *head, char *name) {
-    macro *current = head;
-    while (current) {
-        if (strcmp(current->name, name) == 0) {
-            return current;
-        }
-        current = current->next;
-    }
-    return NULL;
+/* Finds a macro by its name in the table */
+macro *findMacro(macroTable *table, span name) {
+    int id = findString(table->names, name);
+
+    /* A name interned for a symbol after the last macro has no slot */
+    return id == NO_STRING || id >= table->byNameCapacity ? NULL : table->byName[id];
 }
 
 /* Checks if a macro name is valid */
-bool isValidMacroName(char *name) {
-    if (isInstruction(name) || isDirective(name)) {
-        return false;
-    }
-    return true;
+bool isValidMacroName(span name) {
+    int id = keywordOf(name);
+    return !IS_OPERATION(id) && !IS_DIRECTIVE(id);
 }
 
-/* Frees all macros and their associated memory */
-void freeMacros(macro *head) {
-    macro *current;
-    int i;
-    while (head) {
-        current = head;
-        head = head->next;
-        for (i = 0; i < current->lineCount; i++) {
-            free(current->lines[i]);
+/* Removes every macro from the table, keeping the memory of the table */
+void clearMacros(macroTable *table) {
+    int id;
+
+    for (id = 0; id < table->byNameCapacity; id++) {
+        if (table->byName[id] != NULL) {
+            freeMacro(table->byName[id]);
+            table->byName[id] = NULL;
         }
-        free(current->lines);
-        free(current->name);
-        free(current);
     }
+    table->count = 0;
 }
 
-/* Free the memory allocated for a linked list of code lines */
-void freeLines(codeLine *head) {
-    while (head != NULL) {
-        codeLine *current;
-        current = head;
-        head = head->next;
-        free(current->line);
-        free(current);
+/* Frees all macros and their associated memory */
+void freeMacros(macroTable *table) {
+    int id;
+
+    for (id = 0; id < table->byNameCapacity; id++) {
+        if (table->byName[id] != NULL) {
+            freeMacro(table->byName[id]);
+        }
     }
-}
\ No newline at end of file
+    free(table->byName);
+    free(table);
+}
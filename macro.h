@@ -3,51 +3,69 @@
 
 #include <stdbool.h>
 
+#include "header.h"
+#include "stringPool.h"
+
+#define INITIAL_MACRO_LINES 4
+
 /* Structure representing a macro. */
 typedef struct macro {
-    char *name;               /* The name of the macro */
-    char **lines;             /* Array of lines associated with the macro */
+    int nameId;               /* The ID of the name of the macro in the table's string pool */
+    int *lines;               /* The lines of the macro, by their number in the token stream of the source */
     int lineCount;            /* Number of lines in the macro */
-    struct macro *next;       /* Pointer to the next macro in the list */
+    int lineCapacity;         /* Number of lines the array can hold */
 } macro;
 
-/* Structure representing a line of code. */
-typedef struct codeLine {
-    char *line;               /* The line of code */
-    struct codeLine *next;    /* Pointer to the next line in the list */
-} codeLine;
+/* Structure representing the macros of a file.
+ * Macro names are interned, and the macro of each name is kept in an array indexed by the name's ID.
+ * The names are interned in the pool of the symbol table, which owns it. */
+typedef struct {
+    stringPool *names;        /* The pool the names of the macros are interned in */
+    macro **byName;           /* The macro of each name ID */
+    int byNameCapacity;       /* Number of name IDs the array can hold */
+    int count;                /* Number of macros defined */
+} macroTable;
+
+/*
+ * Initializes an empty macro table.
+ *
+ * @param names The string pool of the symbol table, which the macro names share.
+ * @return A pointer to the newly created macro table.
+ */
+macroTable *initMacroTable(stringPool *names);
 
 /*
- * Adds a new macro to the macro list.
+ * Adds a new macro to the macro table.
  *
- * This function allocates memory for a new macro and its name, and adds the macro
- * to the beginning of the macro list.
+ * This function allocates memory for a new macro and interns its name. A redefinition
+ * replaces the previous macro of the same name.
  *
- * @param head A pointer to the pointer to the head of the macro list.
+ * @param table A pointer to the macro table.
  * @param name The name of the new macro to be added.
+ * @return A pointer to the new macro.
  */
-void addMacro(macro **head, char *name);
+macro *addMacro(macroTable *table, span name);
 
 /* Adds a line to a macro's lines list.
  *
- * This function reallocates memory for the macro's lines list to include a new line,
- * and updates the macro's line count.
+ * This function appends the number of the line, whose text and words stay in the token
+ * stream of the source. The array of lines grows geometrically.
  *
  * @param macro A pointer to the macro to which the line will be added.
- * @param line The line to be added to the macro.
+ * @param line The number of the line in the token stream of the source.
  */
-void addMacroLine(macro *macro, char *line);
+void addMacroLine(macro *macro, int line);
 
-/* Finds a macro by its name in the list.
+/* Finds a macro by its name in the table.
  *
- * This function searches through the macro list and returns a pointer to the macro
- * with the given name.
+ * This function looks the name up in the string pool, a name that was never
+ * interned is not a macro.
  *
- * @param head A pointer to the head of the macro list.
+ * @param table A pointer to the macro table.
  * @param name The name of the macro to find.
  * @return A pointer to the macro with the given name, or NULL if not found.
  */
-macro *findMacro(macro *head, char *name);
+macro *findMacro(macroTable *table, span name);
 
 /* Checks if a macro name is valid.
  *
@@ -57,34 +75,24 @@ macro *findMacro(macro *head, char *name);
  * @param name The name to be checked.
  * @return true if the name is a valid macro name, false otherwise.
  */
-bool isValidMacroName(char *name);
+bool isValidMacroName(span name);
 
-/* Frees all macros and their associated memory.
- *
- * This function iterates through the macro list and deallocates memory for each
- * macro's lines and name, as well as the macro structure itself.
- *
- * @param head A pointer to the head of the macro list.
- */
-void freeMacros(macro *head);
-
-/* Adds a new line to the end of a code line list.
+/* Removes every macro from the table.
  *
- * This function reallocates memory for the code lines list to include a new line,
- * and updates the list with the new line.
+ * The macros and their lines are freed, the table keeps its memory for the next
+ * source. The names are cleared with the symbol table.
  *
- * @param head A pointer to the pointer to the head of the code line list.
- * @param line The line of code to be added.
+ * @param table A pointer to the macro table.
  */
-void addCodeLine(codeLine **head, char *line);
+void clearMacros(macroTable *table);
 
-/* Frees all code lines and their associated memory.
+/* Frees all macros and their associated memory.
  *
- * This function iterates through the code line list and deallocates memory for each
- * line and the code line structure itself.
+ * This function deallocates memory for each macro's array of lines, the macro
+ * structures, and the table itself. The names are freed with the symbol table.
  *
- * @param head A pointer to the head of the code line list.
+ * @param table A pointer to the macro table.
  */
-void freeLines(codeLine *head);
+void freeMacros(macroTable *table);
 
 #endif
@@ -1,101 +1,128 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include <stdbool.h>
 
+#include "header.h"
+#include "stringPool.h"
 
 #define MEMORY_LINE 15
+#define INITIAL_SEGMENT_CAPACITY 256
 
-/* Structure representing a node in the data list. */
-typedef struct dataList {
-    int count;                /* Number of items in the data list */
-    unsigned short line;      /* Data line value */
-    struct dataList *next;    /* Pointer to the next node in the data list */
-} dataList;
-
-/* Structure representing a node in the instruction list. */
-typedef struct instructionList {
-    int count;                /* Number of items in the instruction list */
-    char *symbolOperand;      /* Pointer to the symbol operand */
-    unsigned short line;      /* Instruction line value */
-    struct instructionList *next; /* Pointer to the next node in the instruction list */
-} instructionList;
+/* Structure representing a symbol operand whose address is written when the fixups are resolved. */
+typedef struct {
+    int position;             /* Position of the operand word in the code segment */
+    int nameId;               /* ID of the name of the symbol operand in the string pool */
+} symbolReference;
+
+/* Structure representing the first code word produced by a source line. */
+typedef struct {
+    int position;             /* Position of the word in the code segment */
+    int line;                 /* Number of the source line, the line of the macro call for the lines of a macro */
+} lineRecord;
+
+/* Structure representing the data segment: the data words in order of their address. */
+typedef struct {
+    unsigned short *words;    /* The data words */
+    int count;                /* Number of words in the segment */
+    int capacity;             /* Number of words the segment can hold */
+} dataSegment;
+
+/* Structure representing the code segment: the instruction words in order of their address,
+ * and a side table of the words that hold the address of a symbol. */
+typedef struct {
+    unsigned short *words;         /* The instruction words */
+    int count;                     /* Number of words in the segment */
+    int capacity;                  /* Number of words the segment can hold */
+    symbolReference *references;   /* Words that refer to a symbol, in order of their position */
+    int referenceCount;            /* Number of references */
+    int referenceCapacity;         /* Number of references the table can hold */
+    bool keepLines;                /* Whether the source line of the words is recorded */
+    int line;                      /* The source line being processed, recorded with new words */
+    lineRecord *lines;             /* The first word of each run of words of one source line */
+    int lineCount;                 /* Number of line records */
+    int lineCapacity;              /* Number of line records the table can hold */
+} codeSegment;
 
 /*
- * Initializes a new data list.
+ * Initializes a new data segment.
  *
- * This function allocates and initializes a new data list.
+ * This function allocates an empty data segment.
  *
- * @return A pointer to the newly created data list.
+ * @return A pointer to the newly created data segment.
  */
-dataList *initDataList();
+dataSegment *initDataSegment();
 
 /*
- * Allocates and initializes a new data list node.
+ * Makes room for words at the end of the data segment.
  *
- * This function allocates memory for a new data list node and initializes it.
+ * The segment grows geometrically until the words fit. The caller writes the words from the
+ * returned pointer and adds their number to the count of the segment; the pointer is only
+ * valid until the segment grows again.
  *
- * @return A pointer to the newly created data list node.
+ * @param segment A pointer to the data segment.
+ * @param count The number of words to make room for.
+ * @return A pointer to the first word past the end of the segment.
  */
-dataList *allocateNewDNode();
+unsigned short *reserveDataSegment(dataSegment *segment, int count);
 
 /*
- * Adds a new node to the end of the data list.
+ * Removes every word from the data segment.
  *
- * This function creates a new data node and appends it to the end of the data list.
+ * The memory of the segment is kept for the next source.
  *
- * @param tail A pointer to the pointer to the last node in the data list.
- * @param count The count value for the new node.
- * @param line The line value for the new node.
+ * @param segment A pointer to the data segment.
  */
-void addToDataList(dataList **tail, int count, unsigned short line);
+void clearDataSegment(dataSegment *segment);
 
 /*
- * Frees all nodes in the data list.
+ * Frees the data segment.
  *
- * This function releases the memory allocated for all nodes in the data list.
+ * This function releases the memory allocated for the words and the segment itself.
  *
- * @param list A pointer to the head of the data list to be freed.
+ * @param segment A pointer to the data segment to be freed.
  */
-void freeDataList(dataList *list);
+void freeDataSegment(dataSegment *segment);
 
 /*
- * Initializes a new instruction list.
+ * Initializes a new code segment.
  *
- * This function allocates and initializes a new instruction list.
+ * This function allocates an empty code segment with an empty reference table.
  *
- * @return A pointer to the newly created instruction list.
+ * @return A pointer to the newly created code segment.
  */
-instructionList *initInstructionList();
+codeSegment *initCodeSegment();
 
 /*
- * Allocates and initializes a new instruction list node.
+ * Appends a word to the code segment.
  *
- * This function allocates memory for a new instruction list node and initializes it.
+ * The segment grows geometrically when it is full. When the word holds the address
+ * of a symbol, the ID of the symbol name is kept in the reference table. When the
+ * segment keeps lines, a word of a new source line starts a line record.
  *
- * @return A pointer to the newly created instruction list node.
+ * @param segment A pointer to the code segment.
+ * @param nameId The ID of the symbol whose address the word holds, or NO_STRING.
+ * @param line The instruction word to add.
  */
-instructionList *allocateNewINode();
+void addToCodeSegment(codeSegment *segment, int nameId, unsigned short line);
 
 /*
- * Adds a new node to the end of the instruction list.
+ * Removes every word and reference from the code segment.
  *
- * This function creates a new instruction node and appends it to the end of the instruction list.
+ * The memory of the segment is kept for the next source.
  *
- * @param tail A pointer to the pointer to the last node in the instruction list.
- * @param operand A string representing the symbol operand for the new node.
- * @param count The count value for the new node.
- * @param line The line value for the new node.
+ * @param segment A pointer to the code segment.
  */
-void addToInstructionList(instructionList **tail, char *operand, int count, unsigned short line);
+void clearCodeSegment(codeSegment *segment);
 
 /*
- * Frees all nodes in the instruction list.
+ * Frees the code segment.
  *
- * This function releases the memory allocated for all nodes in the instruction list.
+ * This function releases the memory allocated for the words, the reference table
+ * and the segment itself.
  *
- * @param list A pointer to the head of the instruction list to be freed.
+ * @param segment A pointer to the code segment to be freed.
  */
-void freeInstructionList(instructionList *list);
+void freeCodeSegment(codeSegment *segment);
 
 #endif
-
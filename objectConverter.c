@@ -0,0 +1,90 @@
+/*
+ * objectConverter.c
+ *
+ * Description:
+ * Converts the output of the assembler between the text object files
+ * (.ob, .ent and .ext) and the binary object file written with --format=bin.
+ * The conversion is lossless in both directions.
+ *
+ * Usage:
+ *   ./objconv --to-bin prog.ob [prog2.ob ...]     writes prog.bin
+ *   ./objconv --to-text prog.bin [prog2.bin ...]  writes prog.ob, prog.ent and prog.ext
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "objectFile.h"
+#include "outputFiles.h"
+
+/*
+ * Converts the text object files of a program to a binary object file.
+ * @param objectFileName The name of the .ob file; the .ent and .ext files are found next to it.
+ * @return true if the file was converted, false otherwise.
+ */
+static bool convertToBinary(char *objectFileName) {
+    char *entryFileName, *externalFileName, *binaryFileName;
+    objectModule module;
+    bool success;
+
+    entryFileName = changeFileExtension(objectFileName, ".ent");
+    externalFileName = changeFileExtension(objectFileName, ".ext");
+    binaryFileName = changeFileExtension(objectFileName, BINARY_OBJECT_EXTENSION);
+
+    success = readTextObject(objectFileName, entryFileName, externalFileName, &module);
+    if (success) {
+        success = writeBinaryObject(binaryFileName, &module) >= 0;
+        freeObjectModule(&module);
+    }
+
+    free(entryFileName);
+    free(externalFileName);
+    free(binaryFileName);
+    return success;
+}
+
+/*
+ * Converts a binary object file to the text object files.
+ * @param binaryFileName The name of the binary object file.
+ * @return true if the file was converted, false otherwise.
+ */
+static bool convertToText(char *binaryFileName) {
+    mappedObject object;
+    objectModule module;
+    bool success;
+
+    if (!mapBinaryObject(binaryFileName, &object)) {
+        return false;
+    }
+    loadMappedObject(&object, &module);
+    unmapBinaryObject(&object);
+
+    success = createTextObjectFiles(binaryFileName, &module) >= 0;
+    freeObjectModule(&module);
+    return success;
+}
+
+/*
+ * Main function of the converter.
+ * @param argc The number of command-line arguments.
+ * @param argv The direction of the conversion and the files to convert.
+ */
+int main(int argc, char *argv[]) {
+    bool toBinary;
+    int i, status = 0;
+
+    if (argc < 3 || (strcmp(argv[1], "--to-bin") != 0 && strcmp(argv[1], "--to-text") != 0)) {
+        printf("Usage: %s --to-bin <file.ob> ... | --to-text <file.bin> ...\n", argv[0]);
+        return 1;
+    }
+
+    toBinary = strcmp(argv[1], "--to-bin") == 0;
+    for (i = 2; i < argc; i++) {
+        if (!(toBinary ? convertToBinary(argv[i]) : convertToText(argv[i]))) {
+            fprintf(stderr, "Error converting file: %s\n", argv[i]);
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,405 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "assembler.h"
+#include "objectFile.h"
+#include "outputFiles.h"
+
+/* Initializes an empty object module. */
+void initObjectModule(objectModule *module) {
+    memset(module, 0, sizeof(objectModule));
+}
+
+/* Appends a symbol to the entry or the extern table of a module. */
+void addObjectSymbol(objectModule *module, int table, const char *name, int length, int address) {
+    objectSymbol **symbols = table == ENTRY_TABLE ? &module->entries : &module->externs;
+    int *count = table == ENTRY_TABLE ? &module->entryCount : &module->externCount;
+    int *capacity = table == ENTRY_TABLE ? &module->entryCapacity : &module->externCapacity;
+    objectSymbol *symbol;
+
+    /* Grow the table geometrically */
+    if (*count == *capacity) {
+        *capacity = *capacity ? 2 * *capacity : INITIAL_OBJECT_SYMBOLS;
+        *symbols = reallocateMemory(*symbols, *capacity * sizeof(objectSymbol));
+    }
+
+    symbol = &(*symbols)[(*count)++];
+    if (length > MAX_LABEL_LENGTH - 1) {
+        length = MAX_LABEL_LENGTH - 1;
+    }
+    memcpy(symbol->name, name, length);
+    symbol->name[length] = '\0';
+    symbol->address = address;
+}
+
+/* Frees the tables of a module, and its words when the module owns them. */
+void freeObjectModule(objectModule *module) {
+    if (module->ownsWords) {
+        free(module->code);
+        free(module->data);
+    }
+    free(module->entries);
+    free(module->externs);
+    initObjectModule(module);
+}
+
+/* Writes the records of a symbol table of the binary format. */
+static void storeSymbols(unsigned char *p, objectSymbol *symbols, int count) {
+    int i;
+    for (i = 0; i < count; i++, p += OBJECT_SYMBOL_SIZE) {
+        store32(p, (unsigned long) symbols[i].address);
+        memset(p + 4, 0, OBJECT_NAME_SIZE);
+        strncpy((char *) p + 4, symbols[i].name, OBJECT_NAME_SIZE - 1);
+    }
+}
+
+/* Appends a module in the binary object format to a buffer. */
+void formatBinaryObject(objectModule *module, byteBuffer *buffer) {
+    long words = (long) module->codeCount + module->dataCount;
+    long entryOffset, externOffset, size;
+    unsigned char *image, *p;
+    int i;
+
+    /* The tables follow the words, aligned to 4 bytes */
+    entryOffset = (OBJECT_HEADER_SIZE + words * OBJECT_WORD_SIZE + 3) & ~3L;
+    externOffset = entryOffset + (long) module->entryCount * OBJECT_SYMBOL_SIZE;
+    size = externOffset + (long) module->externCount * OBJECT_SYMBOL_SIZE;
+
+    /* Build the whole image in place */
+    image = (unsigned char *) extendByteBuffer(buffer, size);
+    memset(image, 0, size);
+
+    memcpy(image, OBJECT_MAGIC, 4);
+    store16(image + 4, OBJECT_VERSION);
+    store16(image + 6, module->hasExternals ? OBJECT_HAS_EXTERNALS : 0);
+    store32(image + 8, (unsigned long) module->codeCount);
+    store32(image + 12, (unsigned long) module->dataCount);
+    store32(image + 16, (unsigned long) module->loadBase);
+    store32(image + 20, (unsigned long) module->dataBase);
+    store32(image + 24, (unsigned long) entryOffset);
+    store32(image + 28, (unsigned long) module->entryCount);
+    store32(image + 32, (unsigned long) externOffset);
+    store32(image + 36, (unsigned long) module->externCount);
+
+    p = image + OBJECT_HEADER_SIZE;
+    for (i = 0; i < module->codeCount; i++, p += OBJECT_WORD_SIZE) {
+        store16(p, module->code[i]);
+    }
+    for (i = 0; i < module->dataCount; i++, p += OBJECT_WORD_SIZE) {
+        store16(p, module->data[i]);
+    }
+    storeSymbols(image + entryOffset, module->entries, module->entryCount);
+    storeSymbols(image + externOffset, module->externs, module->externCount);
+}
+
+/* Writes a module in the binary object format. */
+long writeBinaryObject(const char *fileName, objectModule *module) {
+    byteBuffer image;
+    long size;
+    FILE *file;
+
+    /* Build the whole image, then write it at once */
+    initByteBuffer(&image);
+    formatBinaryObject(module, &image);
+    size = image.length;
+
+    file = fopen(fileName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot open file %s for writing.\n", fileName);
+        freeByteBuffer(&image);
+        return -1;
+    }
+    if (fwrite(image.data, 1, size, file) != (size_t) size) {
+        fprintf(stderr, "Error: Cannot write file %s.\n", fileName);
+        size = -1;
+    }
+    fclose(file);
+    freeByteBuffer(&image);
+    return size;
+}
+
+/* Checks that every name of a table is null terminated inside its record. */
+static bool validNames(mappedObject *object, int table) {
+    const unsigned char *p = (const unsigned char *) object->file.text + object->tableOffsets[table];
+    int i;
+    for (i = 0; i < object->tableCounts[table]; i++, p += OBJECT_SYMBOL_SIZE) {
+        if (p[OBJECT_SYMBOL_SIZE - 1] != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Maps a binary object file and checks its header and its size. */
+bool mapBinaryObject(const char *fileName, mappedObject *object) {
+    const unsigned char *header;
+    unsigned long codeCount, dataCount, tableCounts[2], tableOffsets[2];
+    long length;
+    int table;
+
+    if (!openSourceBuffer(fileName, &object->file)) {
+        fprintf(stderr, "Error opening object file: %s\n", fileName);
+        return false;
+    }
+    header = (const unsigned char *) object->file.text;
+    length = object->file.length;
+
+    if (length < OBJECT_HEADER_SIZE || memcmp(header, OBJECT_MAGIC, 4) != 0 ||
+        LOAD16(header + 4) != OBJECT_VERSION) {
+        fprintf(stderr, "Error: %s is not a binary object file of version %d\n", fileName, OBJECT_VERSION);
+        closeSourceBuffer(&object->file);
+        return false;
+    }
+
+    object->flags = (int) LOAD16(header + 6);
+    codeCount = LOAD32(header + 8);
+    dataCount = LOAD32(header + 12);
+    object->loadBase = (int) LOAD32(header + 16);
+    object->dataBase = (int) LOAD32(header + 20);
+    tableOffsets[ENTRY_TABLE] = LOAD32(header + 24);
+    tableCounts[ENTRY_TABLE] = LOAD32(header + 28);
+    tableOffsets[EXTERN_TABLE] = LOAD32(header + 32);
+    tableCounts[EXTERN_TABLE] = LOAD32(header + 36);
+
+    /* Every part of the file has to be inside it */
+    if (OBJECT_HEADER_SIZE + (codeCount + dataCount) * OBJECT_WORD_SIZE > (unsigned long) length) {
+        fprintf(stderr, "Error: %s is truncated\n", fileName);
+        closeSourceBuffer(&object->file);
+        return false;
+    }
+    for (table = ENTRY_TABLE; table <= EXTERN_TABLE; table++) {
+        if (tableOffsets[table] > (unsigned long) length ||
+            tableCounts[table] > ((unsigned long) length - tableOffsets[table]) / OBJECT_SYMBOL_SIZE) {
+            fprintf(stderr, "Error: %s is truncated\n", fileName);
+            closeSourceBuffer(&object->file);
+            return false;
+        }
+        object->tableOffsets[table] = (long) tableOffsets[table];
+        object->tableCounts[table] = (int) tableCounts[table];
+    }
+    object->codeCount = (int) codeCount;
+    object->dataCount = (int) dataCount;
+
+    if (!validNames(object, ENTRY_TABLE) || !validNames(object, EXTERN_TABLE)) {
+        fprintf(stderr, "Error: %s has an invalid symbol name\n", fileName);
+        closeSourceBuffer(&object->file);
+        return false;
+    }
+    return true;
+}
+
+/* Returns a word of a mapped object. */
+unsigned short mappedObjectWord(mappedObject *object, int index) {
+    const unsigned char *p = (const unsigned char *) object->file.text + OBJECT_HEADER_SIZE;
+    return (unsigned short) LOAD16(p + (long) index * OBJECT_WORD_SIZE);
+}
+
+/* Returns a record of the entry or the extern table of a mapped object. */
+int mappedObjectSymbol(mappedObject *object, int table, int index, const char **name) {
+    const unsigned char *p = (const unsigned char *) object->file.text + object->tableOffsets[table] +
+                             (long) index * OBJECT_SYMBOL_SIZE;
+    *name = (const char *) p + 4;
+    return (int) LOAD32(p);
+}
+
+/* Releases a mapped object. */
+void unmapBinaryObject(mappedObject *object) {
+    closeSourceBuffer(&object->file);
+}
+
+/* Allocates an array of words, at least one so that an empty segment is not NULL. */
+static unsigned short *allocateWords(int count) {
+    return allocateMemory((count > 0 ? count : 1) * sizeof(unsigned short));
+}
+
+/* Copies a mapped object into a module. */
+void loadMappedObject(mappedObject *object, objectModule *module) {
+    const char *name;
+    int i, table, address;
+
+    initObjectModule(module);
+    module->ownsWords = true;
+    module->codeCount = object->codeCount;
+    module->dataCount = object->dataCount;
+    module->loadBase = object->loadBase;
+    module->dataBase = object->dataBase;
+    module->hasExternals = (object->flags & OBJECT_HAS_EXTERNALS) != 0;
+
+    module->code = allocateWords(module->codeCount);
+    module->data = allocateWords(module->dataCount);
+    for (i = 0; i < module->codeCount; i++) {
+        module->code[i] = mappedObjectWord(object, i);
+    }
+    for (i = 0; i < module->dataCount; i++) {
+        module->data[i] = mappedObjectWord(object, module->codeCount + i);
+    }
+
+    for (table = ENTRY_TABLE; table <= EXTERN_TABLE; table++) {
+        for (i = 0; i < object->tableCounts[table]; i++) {
+            address = mappedObjectSymbol(object, table, i, &name);
+            addObjectSymbol(module, table, name, (int) strlen(name), address);
+        }
+    }
+}
+
+/*
+ * Reads the next number of a text, after the white space before it, the way fscanf reads %d or %o.
+ * @param cursor The position in the text; it is moved past the number.
+ * @param end The end of the text.
+ * @param base 10 or 8.
+ * @param value Receives the number.
+ * @return true if there was a number, false at the end of the text or before anything else.
+ */
+static bool scanNumber(const char **cursor, const char *end, int base, long *value) {
+    const char *p = *cursor;
+    long number = 0;
+    int sign = 1;
+
+    while (p < end && isspace((unsigned char) *p)) {
+        p++;
+    }
+    if (p < end && (*p == '-' || *p == '+')) {
+        sign = *p++ == '-' ? -1 : 1;
+    }
+    if (p == end || *p < '0' || *p >= '0' + base) {
+        return false;
+    }
+    while (p < end && *p >= '0' && *p < '0' + base) {
+        number = number * base + (*p++ - '0');
+    }
+    *value = sign * number;
+    *cursor = p;
+    return true;
+}
+
+/* Reads the "name address" lines of a .ent or .ext file into a table of the module. */
+static bool readSymbolFile(const char *fileName, objectModule *module, int table) {
+    char name[MAX_LINE_LENGTH + 1];
+    int address, fields;
+    FILE *file;
+
+    file = fopen(fileName, "r");
+    if (file == NULL) {
+        return false;
+    }
+    while ((fields = fscanf(file, "%80s %d", name, &address)) == 2) {
+        addObjectSymbol(module, table, name, (int) strlen(name), address);
+    }
+    fclose(file);
+    if (fields != EOF) {
+        fprintf(stderr, "Error: Invalid line in %s\n", fileName);
+    }
+    return fields == EOF;
+}
+
+/* Reads the text object files of a program into a module. */
+bool readTextObject(const char *objectFileName, const char *entryFileName,
+                    const char *externalFileName, objectModule *module) {
+    int codeLength, dataLength, records = 0, capacity = INITIAL_OBJECT_SYMBOLS, i;
+    long address, word, header[2];
+    unsigned short *words;
+    int *addresses;
+    const char *cursor, *end;
+    sourceBuffer text;
+    bool success;
+    FILE *file;
+
+    initObjectModule(module);
+    if (!openSourceBuffer(objectFileName, &text)) {
+        fprintf(stderr, "Error opening object file: %s\n", objectFileName);
+        return false;
+    }
+    cursor = text.text;
+    end = text.text + text.length;
+    if (!scanNumber(&cursor, end, 10, &header[0]) || !scanNumber(&cursor, end, 10, &header[1]) || header[1] < 0) {
+        fprintf(stderr, "Error: Invalid header in %s\n", objectFileName);
+        closeSourceBuffer(&text);
+        return false;
+    }
+    codeLength = (int) header[0];
+    dataLength = (int) header[1];
+
+    /* Read all the records, the last dataLength of them are the data words */
+    if (codeLength > 0 && (long) codeLength + dataLength < text.length / 4) {
+        capacity += codeLength + dataLength;
+    }
+    words = allocateWords(capacity);
+    addresses = allocateMemory(capacity * sizeof(int));
+    while (scanNumber(&cursor, end, 10, &address) && scanNumber(&cursor, end, 8, &word)) {
+        if (records == capacity) {
+            capacity *= 2;
+            words = reallocateMemory(words, capacity * sizeof(unsigned short));
+            addresses = reallocateMemory(addresses, capacity * sizeof(int));
+        }
+        addresses[records] = (int) address;
+        words[records++] = (unsigned short) word;
+    }
+    while (cursor < end && isspace((unsigned char) *cursor)) {
+        cursor++;
+    }
+    success = cursor == end && records >= dataLength;
+    closeSourceBuffer(&text);
+
+    module->ownsWords = true;
+    module->code = words;
+    module->codeCount = success ? records - dataLength : 0;
+    module->dataCount = success ? dataLength : 0;
+    module->data = allocateWords(module->dataCount);
+    memcpy(module->data, words + module->codeCount, module->dataCount * sizeof(unsigned short));
+    /* The program starts at the address of its first record, which ./rebase may have moved */
+    module->loadBase = records > 0 ? addresses[0] : INITIAL_IC;
+    module->dataBase = module->loadBase + codeLength;
+
+    /* The binary format implies the addresses by the order of the words, they have to match */
+    for (i = 0; success && i < records; i++) {
+        success = addresses[i] == (i < module->codeCount ? module->loadBase + i
+                                                         : module->dataBase + i - module->codeCount);
+    }
+    free(addresses);
+    if (!success) {
+        fprintf(stderr, "Error: Invalid record in %s\n", objectFileName);
+    }
+
+    /* The .ent and .ext files exist only when there are entries and externals */
+    if (success && (file = fopen(entryFileName, "r")) != NULL) {
+        fclose(file);
+        success = readSymbolFile(entryFileName, module, ENTRY_TABLE);
+    }
+    if (success && (file = fopen(externalFileName, "r")) != NULL) {
+        fclose(file);
+        module->hasExternals = true;
+        success = readSymbolFile(externalFileName, module, EXTERN_TABLE);
+    }
+
+    if (!success) {
+        freeObjectModule(module);
+    }
+    return success;
+}
+
+/* Reads a program from its object files, in either format. */
+bool readObjectModule(const char *fileName, objectModule *module) {
+    char *entryFileName, *externalFileName;
+    const char *extension = strrchr(fileName, '.');
+    mappedObject object;
+    bool success;
+
+    if (extension != NULL && strcmp(extension, BINARY_OBJECT_EXTENSION) == 0) {
+        if (!mapBinaryObject(fileName, &object)) {
+            return false;
+        }
+        loadMappedObject(&object, module);
+        unmapBinaryObject(&object);
+        return true;
+    }
+
+    entryFileName = changeFileExtension((char *) fileName, ".ent");
+    externalFileName = changeFileExtension((char *) fileName, ".ext");
+    success = readTextObject(fileName, entryFileName, externalFileName, module);
+    free(entryFileName);
+    free(externalFileName);
+    return success;
+}
@@ -0,0 +1,197 @@
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+#include <stdbool.h>
+
+#include "byteBuffer.h"
+#include "header.h"
+#include "memory.h"
+#include "sourceReader.h"
+
+/*
+ * Binary object format (--format=bin), all numbers little-endian:
+ *
+ *   offset  size  field
+ *        0     4  magic "ASMB"
+ *        4     2  format version
+ *        6     2  flags (OBJECT_HAS_EXTERNALS)
+ *        8     4  number of code words
+ *       12     4  number of data words
+ *       16     4  load base, the address of the first code word (INITIAL_IC)
+ *       20     4  data base, the address of the first data word
+ *       24     4  offset of the entry table
+ *       28     4  number of entries
+ *       32     4  offset of the extern table
+ *       36     4  number of extern references
+ *       40        code words then data words, 2 bytes each
+ *
+ * The entry and extern tables hold fixed size records of a 4 byte address and
+ * a null padded name of OBJECT_NAME_SIZE bytes, so every field is found at a
+ * fixed offset and the file can be used straight from a mapping.
+ */
+#define OBJECT_MAGIC "ASMB"
+#define OBJECT_VERSION 1
+#define OBJECT_HEADER_SIZE 40
+#define OBJECT_WORD_SIZE 2
+#define OBJECT_NAME_SIZE 32
+#define OBJECT_SYMBOL_SIZE (4 + OBJECT_NAME_SIZE)
+
+/* Header flags */
+#define OBJECT_HAS_EXTERNALS 1    /* The program declares external symbols, so a .ext file exists */
+
+/* Tables of an object file */
+#define ENTRY_TABLE 0
+#define EXTERN_TABLE 1
+
+#define INITIAL_OBJECT_SYMBOLS 16
+
+/* Structure representing an entry symbol, or a reference to an external symbol. */
+typedef struct {
+    char name[MAX_LABEL_LENGTH];  /* The name of the symbol */
+    int address;                  /* Address of the entry, or of the word referring to the external */
+} objectSymbol;
+
+/* Structure representing the output of assembling a file, independent of its format. */
+typedef struct {
+    unsigned short *code;     /* The code words */
+    int codeCount;            /* Number of code words */
+    unsigned short *data;     /* The data words */
+    int dataCount;            /* Number of data words */
+    int loadBase;             /* Address of the first code word */
+    int dataBase;             /* Address of the first data word */
+    objectSymbol *entries;    /* Entry symbols, in the order of the .ent file */
+    int entryCount;           /* Number of entry symbols */
+    int entryCapacity;        /* Number of entries the array can hold */
+    objectSymbol *externs;    /* References to external symbols, in the order of the .ext file */
+    int externCount;          /* Number of references */
+    int externCapacity;       /* Number of references the array can hold */
+    bool hasExternals;        /* Whether external symbols are declared */
+    bool ownsWords;           /* Whether the word arrays are freed with the module */
+    lineRecord *lines;        /* The source line of the code words, NULL when not recorded; not owned */
+    int lineCount;            /* Number of line records */
+} objectModule;
+
+/* Structure representing a binary object file used in place through a mapping. */
+typedef struct {
+    sourceBuffer file;        /* The mapped file */
+    int flags;                /* Header flags */
+    int codeCount;            /* Number of code words */
+    int dataCount;            /* Number of data words */
+    int loadBase;             /* Address of the first code word */
+    int dataBase;             /* Address of the first data word */
+    long tableOffsets[2];     /* Offsets of the entry and extern tables */
+    int tableCounts[2];       /* Number of records in the entry and extern tables */
+} mappedObject;
+
+/*
+ * Initializes an empty object module.
+ *
+ * @param module The module to initialize.
+ */
+void initObjectModule(objectModule *module);
+
+/*
+ * Appends a symbol to the entry or the extern table of a module.
+ *
+ * The name is truncated to the longest label. The tables grow geometrically.
+ *
+ * @param module The module.
+ * @param table ENTRY_TABLE or EXTERN_TABLE.
+ * @param name The name of the symbol.
+ * @param length The number of characters in the name.
+ * @param address The address of the symbol.
+ */
+void addObjectSymbol(objectModule *module, int table, const char *name, int length, int address);
+
+/*
+ * Frees the tables of a module, and its words when the module owns them.
+ *
+ * @param module The module to free.
+ */
+void freeObjectModule(objectModule *module);
+
+/*
+ * Appends a module in the binary object format to a buffer.
+ *
+ * @param module The module to format.
+ * @param buffer The buffer receiving the image of the file.
+ */
+void formatBinaryObject(objectModule *module, byteBuffer *buffer);
+
+/*
+ * Writes a module in the binary object format.
+ *
+ * @param fileName The name of the file to create.
+ * @param module The module to write.
+ * @return The number of bytes written, -1 if the file could not be written.
+ */
+long writeBinaryObject(const char *fileName, objectModule *module);
+
+/*
+ * Maps a binary object file and checks its header and its size.
+ *
+ * @param fileName The name of the binary object file.
+ * @param object Receives the mapped file.
+ * @return true if the file is a valid binary object, false otherwise.
+ */
+bool mapBinaryObject(const char *fileName, mappedObject *object);
+
+/*
+ * Returns a word of a mapped object, numbering the code words first and the data words after them.
+ *
+ * @param object The mapped object.
+ * @param index The number of the word.
+ * @return The word.
+ */
+unsigned short mappedObjectWord(mappedObject *object, int index);
+
+/*
+ * Returns a record of the entry or the extern table of a mapped object.
+ *
+ * @param object The mapped object.
+ * @param table ENTRY_TABLE or EXTERN_TABLE.
+ * @param index The number of the record.
+ * @param name Receives the name, null terminated inside the mapping.
+ * @return The address of the record.
+ */
+int mappedObjectSymbol(mappedObject *object, int table, int index, const char **name);
+
+/*
+ * Releases a mapped object.
+ *
+ * @param object The mapped object.
+ */
+void unmapBinaryObject(mappedObject *object);
+
+/*
+ * Copies a mapped object into a module.
+ *
+ * @param object The mapped object.
+ * @param module Receives the words and the symbols; it owns its words.
+ */
+void loadMappedObject(mappedObject *object, objectModule *module);
+
+/*
+ * Reads the text object files .ob, .ent and .ext of a program into a module.
+ *
+ * The .ent and .ext files are optional.
+ *
+ * @param objectFileName The name of the .ob file.
+ * @param entryFileName The name of the .ent file.
+ * @param externalFileName The name of the .ext file.
+ * @param module Receives the program; it owns its words.
+ * @return true if the files were read, false if they are missing or malformed.
+ */
+bool readTextObject(const char *objectFileName, const char *entryFileName,
+                    const char *externalFileName, objectModule *module);
+
+/*
+ * Reads a program from its object files, in either format.
+ *
+ * @param fileName The .ob file, with the .ent and .ext files next to it, or a .bin file.
+ * @param module Receives the program; it owns its words.
+ * @return true if the program was read, false otherwise.
+ */
+bool readObjectModule(const char *fileName, objectModule *module);
+
+#endif
@@ -1,129 +1,501 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
+#include "allocation.h"
 #include "assembler.h"
+#include "machineCode.h"
 #include "memory.h"
 #include "outputFiles.h"
 
 /* Changes the file extension of the given file name. */
 char *changeFileExtension(char *fileName, char *newExtension) {
-    char *newFileName, *base;
+    char *newFileName, *extension, *directory;
+    size_t baseLength;
 
-    base = strtok(fileName, ".");  /* Separate base name from extension */
-    newFileName = malloc(strlen(base) + strlen(newExtension) + 1);
-    if (newFileName == NULL) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(EXIT_FAILURE);
+    /* Separate base name from extension without modifying the given name */
+    extension = strrchr(fileName, '.');
+    directory = strrchr(fileName, '/');
+    if (extension == NULL || (directory != NULL && extension < directory)) {
+        baseLength = strlen(fileName);
+    } else {
+        baseLength = extension - fileName;
     }
 
-    strcpy(newFileName, base);   /* Copy base name */
-    strcat(newFileName, newExtension);   /* Add new extension */
+    newFileName = allocateMemory(baseLength + strlen(newExtension) + 1);
+
+    memcpy(newFileName, fileName, baseLength);   /* Copy base name */
+    strcpy(newFileName + baseLength, newExtension);   /* Add new extension */
 
     return newFileName;
 }
 
-/* Creates an object file with machine code and data sections. */
-void createObjectFile(char *filename, instructionList *Ilist, dataList *Dlist, int codeLength, int dataLength) {
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        fprintf(stderr, "Error: Cannot open file %s for writing.\n", filename);
-        exit(EXIT_FAILURE);
+/* Object records per formatting thread, smaller images are formatted on the calling thread */
+#define OBJECT_RECORDS_PER_THREAD 65536
+#define MAX_OBJECT_WRITERS 8
+
+/* Largest word that fits in five octal digits */
+#define MAX_SHORT_WORD 077777
+
+/* Four decimal digits of every number below 10000, and three octal digits of every 9 bit number */
+static char decimalDigits[10000][4];
+static char octalDigits[512][3];
+static pthread_once_t formatTablesOnce = PTHREAD_ONCE_INIT;
+
+/* Structure representing the records one thread formats. */
+typedef struct {
+    objectModule *module;     /* The words of the object file, code words first */
+    int first;                /* Number of the first record */
+    int last;                 /* Number of the record after the last one */
+    char *out;                /* Where the first record is written */
+} objectChunk;
+
+/* Fills the digit tables, once for the whole process. */
+static void buildFormatTables(void) {
+    int i;
+    for (i = 0; i < 10000; i++) {
+        decimalDigits[i][0] = (char) ('0' + i / 1000);
+        decimalDigits[i][1] = (char) ('0' + i / 100 % 10);
+        decimalDigits[i][2] = (char) ('0' + i / 10 % 10);
+        decimalDigits[i][3] = (char) ('0' + i % 10);
     }
+    for (i = 0; i < 512; i++) {
+        octalDigits[i][0] = (char) ('0' + (i >> 6));
+        octalDigits[i][1] = (char) ('0' + ((i >> 3) & 7));
+        octalDigits[i][2] = (char) ('0' + (i & 7));
+    }
+}
 
-    /* Write header: code length and data length */
-    fprintf(file, "%4d %d\n", codeLength - INITIAL_IC, dataLength);
+/* Returns the address and the word of a record. */
+static void recordAt(objectModule *module, int record, int *address, unsigned short *word) {
+    if (record < module->codeCount) {
+        *address = module->loadBase + record;
+        *word = module->code[record];
+    } else {
+        record -= module->codeCount;
+        *address = module->dataBase + record;
+        *word = module->data[record];
+    }
+}
 
-    while (Ilist != NULL && Ilist->count != 0) {
-        /* Write each instruction in octal format */
-        fprintf(file, "%04d %05o\n", Ilist->count, Ilist->line);
-        Ilist = Ilist->next;
+/* Returns the length of the record "%04d %05o\n" of an address and a word. */
+static int recordLength(int address, unsigned short word) {
+    int length = 4 + 1 + 5 + 1;
+    for (address /= 10000; address > 0; address /= 10) {
+        length++;
     }
+    return length + (word > MAX_SHORT_WORD);
+}
+
+/* Formats the record "%04d %05o\n" of an address and a word, and returns the end of the record. */
+static char *formatRecord(char *out, int address, unsigned short word) {
+    char high[12];
+    int length = 0, rest;
 
-    while (Dlist != NULL) {
-        /* Write each data line in octal format */
-        if (Dlist->next != NULL) {
-            fprintf(file, "%04d %05o\n", Dlist->count + codeLength, Dlist->line);
+    /* Digits above the four padded ones, for addresses of 10000 and more */
+    if (address >= 10000) {
+        for (rest = address / 10000; rest > 0; rest /= 10) {
+            high[length++] = (char) ('0' + rest % 10);
         }
-        Dlist = Dlist->next;
+        while (length > 0) {
+            *out++ = high[--length];
+        }
+        address %= 10000;
     }
-    /* Close the file after writing */
-    fclose(file);
+    memcpy(out, decimalDigits[address], 4);
+    out[4] = ' ';
+    out += 5;
+
+    /* Five octal digits, and a sixth for the sixteenth bit */
+    if (word > MAX_SHORT_WORD) {
+        *out++ = '1';
+    }
+    memcpy(out, octalDigits[(word >> 9) & 077] + 1, 2);
+    memcpy(out + 2, octalDigits[word & 0777], 3);
+    out[5] = '\n';
+    return out + 6;
 }
 
-/* Creates a file listing all entry symbols with their addresses, only if entry symbols exist. */
-void cerateEntriesFile(char *filename, symbolTable *symTable) {
-    FILE *file = NULL;
+/* Formats the records of a chunk. */
+static void *formatChunk(void *arg) {
+    objectChunk *chunk = (objectChunk *) arg;
+    char *out = chunk->out;
+    unsigned short word;
+    int record, address;
+
+    for (record = chunk->first; record < chunk->last; record++) {
+        recordAt(chunk->module, record, &address, &word);
+        out = formatRecord(out, address, word);
+    }
+    return NULL;
+}
+
+/* Returns the number of threads the records are formatted on. */
+static int objectWriters(int records) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int writers = records / OBJECT_RECORDS_PER_THREAD + 1;
+
+    if (writers > processors) {
+        writers = processors > 0 ? (int) processors : 1;
+    }
+    return writers > MAX_OBJECT_WRITERS ? MAX_OBJECT_WRITERS : writers;
+}
+
+/* Splits the records of a module between the formatting threads.
+ * Returns the size of the text, and finds where the records of each thread start. */
+static long planObjectText(objectModule *module, objectChunk *chunks, long *offsets, int *writers,
+                           char *header, int *headerLength) {
+    int records, i, record, address;
+    unsigned short word;
+    long size;
+
+    pthread_once(&formatTablesOnce, buildFormatTables);
+    records = module->codeCount + module->dataCount;
+    *writers = objectWriters(records);
+
+    /* Header: code length and data length */
+    *headerLength = sprintf(header, "%4d %d\n", module->dataBase - module->loadBase, module->dataCount);
+
+    size = *headerLength;
+    for (i = 0; i < *writers; i++) {
+        chunks[i].module = module;
+        chunks[i].first = (int) ((long) records * i / *writers);
+        chunks[i].last = (int) ((long) records * (i + 1) / *writers);
+        offsets[i] = size;
+        for (record = chunks[i].first; record < chunks[i].last; record++) {
+            recordAt(module, record, &address, &word);
+            size += recordLength(address, word);
+        }
+    }
+    return size;
+}
+
+/* Formats the header and the records into a text of the planned size. */
+static void formatObjectText(char *text, objectChunk *chunks, long *offsets, int writers,
+                             char *header, int headerLength) {
+    pthread_t threads[MAX_OBJECT_WRITERS];
+    bool started[MAX_OBJECT_WRITERS];
     int i;
 
-    for (i = 0; i < symTable->count; i++) {
-        if (strcmp(symTable->symbols[i]->type, "entry") == 0) {
-            if (file == NULL) {
-                file = fopen(filename, "w");
-                if (file == NULL) {
-                    fprintf(stderr, "Error: Cannot open file %s for writing.\n", filename);
-                    exit(EXIT_FAILURE);
-                }
-            }
-            /* Write each entry symbol's name and address */
-            fprintf(file, "%s %d\n", symTable->symbols[i]->name, symTable->symbols[i]->address);
+    memcpy(text, header, headerLength);
+    for (i = 0; i < writers; i++) {
+        chunks[i].out = text + offsets[i];
+    }
+
+    /* Format the first chunk on this thread and the others in parallel */
+    for (i = 1; i < writers; i++) {
+        started[i] = pthread_create(&threads[i], NULL, formatChunk, &chunks[i]) == 0;
+        if (!started[i]) {
+            formatChunk(&chunks[i]);
         }
     }
-    /* Close the file if it was opened */
-    if (file != NULL) {
-        fclose(file);
+    formatChunk(&chunks[0]);
+    for (i = 1; i < writers; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
     }
 }
 
+/* Appends the text of the .ob file of a module to a buffer. */
+void formatObjectBuffer(objectModule *module, byteBuffer *buffer) {
+    objectChunk chunks[MAX_OBJECT_WRITERS];
+    long offsets[MAX_OBJECT_WRITERS];
+    char header[32];
+    int writers, headerLength;
+    long size;
 
-/* Creates a file listing all external symbols used in the program, only if external symbols exist. */
-void cerateExternalsFile(char *filename, instructionList *Ilist, ExternalSymbolArray *extArray) {
-    FILE *file;
+    size = planObjectText(module, chunks, offsets, &writers, header, &headerLength);
+    formatObjectText(extendByteBuffer(buffer, size), chunks, offsets, writers, header, headerLength);
+}
+
+/* Appends the text of the .ent file of a module to a buffer. */
+void formatEntries(objectModule *module, byteBuffer *buffer) {
+    char line[MAX_LABEL_LENGTH + 16];
+    int i;
 
-    if (extArray != NULL && extArray->count > 0) {
+    for (i = 0; i < module->entryCount; i++) {
+        /* Each entry symbol's name and address */
+        appendBytes(buffer, line, sprintf(line, "%s %d\n", module->entries[i].name, module->entries[i].address));
+    }
+}
 
-        file = fopen(filename, "w");
-        if (file == NULL) {
-            fprintf(stderr, "Error: Cannot open file %s for writing.\n", filename);
-            exit(EXIT_FAILURE);
+/* Appends the text of the .ext file of a module to a buffer. */
+void formatExternals(objectModule *module, byteBuffer *buffer) {
+    char line[MAX_LABEL_LENGTH + 16];
+    int i;
+
+    for (i = 0; i < module->externCount; i++) {
+        appendBytes(buffer, line, sprintf(line, "%s %04d\n", module->externs[i].name, module->externs[i].address));
+    }
+}
+
+/* Appends the text of the .rel file of a module to a buffer. */
+void formatRelocations(objectModule *module, byteBuffer *buffer) {
+    char line[16];
+    int i;
+
+    /* Only code words carry the A, R and E bits, data words are plain values */
+    for (i = 0; i < module->codeCount; i++) {
+        if ((module->code[i] & ARE_MASK) == (1 << R_BIT)) {
+            appendBytes(buffer, line, sprintf(line, "%04d\n", module->loadBase + i));
         }
+    }
+}
+
+/* Appends the text of the .map file of a module to a buffer. */
+void formatLineMap(objectModule *module, byteBuffer *buffer) {
+    char line[32];
+    int i;
+
+    for (i = 0; i < module->lineCount; i++) {
+        appendBytes(buffer, line, sprintf(line, "%04d %d\n", module->loadBase + module->lines[i].position,
+                                          module->lines[i].line));
+    }
+}
+
+/* Writes a buffer to a file. */
+long writeOutputBuffer(char *filename, byteBuffer *buffer) {
+    FILE *file;
+    long bytes = buffer->length;
 
-        while (Ilist != NULL) {
-            if (Ilist->symbolOperand != NULL) {
-                /* Check if the symbol is external and write it */
-                if (isExternalSymbol(extArray, Ilist->symbolOperand)) {
-                    fprintf(file, "%s %04d\n", Ilist->symbolOperand, Ilist->count);
-                }
-            }
-            Ilist = Ilist->next;
+    file = fopen(filename, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot open file %s for writing.\n", filename);
+        return -1;
+    }
+    if (fwrite(buffer->data, 1, buffer->length, file) != (size_t) buffer->length) {
+        fprintf(stderr, "Error: Cannot write file %s.\n", filename);
+        bytes = -1;
+    }
+    fclose(file);
+    return bytes;
+}
+
+/* Creates an object file with machine code and data sections. */
+long createObjectFile(char *filename, objectModule *module) {
+    byteBuffer text;
+    long bytes;
+
+    initByteBuffer(&text);
+    formatObjectBuffer(module, &text);
+    bytes = writeOutputBuffer(filename, &text);
+    freeByteBuffer(&text);
+    return bytes;
+}
+
+/* Creates a file listing all entry symbols with their addresses, only if entry symbols exist. */
+long cerateEntriesFile(char *filename, objectModule *module) {
+    byteBuffer text;
+    long bytes = 0;
+
+    if (module->entryCount > 0) {
+        initByteBuffer(&text);
+        formatEntries(module, &text);
+        bytes = writeOutputBuffer(filename, &text);
+        freeByteBuffer(&text);
+    }
+    return bytes;
+}
+
+
+/* Creates a file listing all external symbols used in the program, only if external symbols exist. */
+long cerateExternalsFile(char *filename, objectModule *module) {
+    byteBuffer text;
+    long bytes = 0;
+
+    if (module->hasExternals) {
+        initByteBuffer(&text);
+        formatExternals(module, &text);
+        bytes = writeOutputBuffer(filename, &text);
+        freeByteBuffer(&text);
+    }
+    return bytes;
+}
+
+/* Creates a file listing the address of every relocatable word of a module. */
+long createRelocationFile(char *filename, objectModule *module) {
+    byteBuffer text;
+    long bytes;
+
+    initByteBuffer(&text);
+    formatRelocations(module, &text);
+    bytes = writeOutputBuffer(filename, &text);
+    freeByteBuffer(&text);
+    return bytes;
+}
+
+/* Collects the words, the entries and the external references of an assembled file. */
+void buildObjectModule(codeSegment *code, dataSegment *data, int codeLength, symbolTable *symTable,
+                       fixupList *fixups, objectModule *module) {
+    symbolReference *reference;
+    Symbol *symbol;
+    int i;
+
+    initObjectModule(module);
+    module->code = code->words;
+    module->codeCount = code->count;
+    module->data = data->words;
+    module->dataCount = data->count;
+    module->loadBase = INITIAL_IC;
+    module->dataBase = codeLength;
+    if (code->keepLines) {
+        module->lines = code->lines;
+        module->lineCount = code->lineCount;
+    }
+
+    for (i = 0; i < symTable->count; i++) {
+        symbol = &symTable->symbols[i];
+        if (symbol->flags & SYMBOL_ENTRY) {
+            addObjectSymbol(module, ENTRY_TABLE, symbolName(symTable, symbol),
+                            poolStringLength(symTable->names, symbol->nameId), symbolAddress(symTable, symbol));
+        } else if (symbol->flags & SYMBOL_EXTERNAL) {
+            module->hasExternals = true;
         }
-        /* Close the file after writing */
-        fclose(file);
+    }
+
+    /* The external references were recorded when the fixups were resolved */
+    for (i = 0; i < fixups->externalCount; i++) {
+        reference = &fixups->externals[i];
+        addObjectSymbol(module, EXTERN_TABLE, poolString(symTable->names, reference->nameId),
+                        poolStringLength(symTable->names, reference->nameId), INITIAL_IC + reference->position);
     }
 }
 
-/* Creates all necessary output files for the assembler. */
-void createOutputFiles(char *sourceFileName, instructionList *Ilist, dataList *Dlist, int codeLength, int dataLength, symbolTable *symTable) {
+/* Creates the .ob, .ent and .ext files of a module. */
+long createTextObjectFiles(char *fileName, objectModule *module) {
     char *objectFileName, *entryFileName, *externalFileName;
-    ExternalSymbolArray *extArray;
+    long objectBytes, entryBytes, externalBytes;
 
     /* Create file names with appropriate extensions. */
-    objectFileName = changeFileExtension(sourceFileName, ".ob");
-    entryFileName = changeFileExtension(sourceFileName, ".ent");
-    externalFileName = changeFileExtension(sourceFileName, ".ext");
-
-    /* Create an array for external symbols. */
-    extArray = initExternalSymbolArray();
-    createExternalSymbolsArray(symTable, extArray);
+    objectFileName = changeFileExtension(fileName, ".ob");
+    entryFileName = changeFileExtension(fileName, ".ent");
+    externalFileName = changeFileExtension(fileName, ".ext");
 
     /* Create the output files. */
-    createObjectFile(objectFileName, Ilist, Dlist, codeLength, dataLength);
-    cerateEntriesFile(entryFileName, symTable);
-    cerateExternalsFile(externalFileName, Ilist, extArray);
+    objectBytes = createObjectFile(objectFileName, module);
+    entryBytes = cerateEntriesFile(entryFileName, module);
+    externalBytes = cerateExternalsFile(externalFileName, module);
 
     /* Free allocated memory */
     free(objectFileName);
     free(entryFileName);
     free(externalFileName);
-    freeExternalSymbolArray(extArray);
+
+    if (objectBytes < 0 || entryBytes < 0 || externalBytes < 0) {
+        return -1;
+    }
+    return objectBytes + entryBytes + externalBytes;
+}
+
+/* Initializes empty output buffers. */
+void initObjectBuffers(objectBuffers *output) {
+    output->format = FORMAT_TEXT;
+    initByteBuffer(&output->object);
+    initByteBuffer(&output->entries);
+    initByteBuffer(&output->externals);
+    initByteBuffer(&output->relocations);
+    initByteBuffer(&output->lineMap);
+    output->hasEntries = false;
+    output->hasExternals = false;
+    output->hasRelocations = false;
+    output->hasLineMap = false;
+}
+
+/* Formats the output files of a module into memory. */
+long formatObjectBuffers(objectModule *module, const assemblerOptions *options, objectBuffers *output) {
+    /* The buffers keep their memory from one file to the next */
+    output->format = options->objectFormat;
+    output->object.length = output->entries.length = output->externals.length = 0;
+    output->relocations.length = output->lineMap.length = 0;
+
+    output->hasRelocations = options->writeRelocations;
+    if (options->writeRelocations) {
+        formatRelocations(module, &output->relocations);
+    }
+    output->hasLineMap = options->writeLineMap;
+    if (options->writeLineMap) {
+        formatLineMap(module, &output->lineMap);
+    }
+
+    if (output->format == FORMAT_BINARY) {
+        formatBinaryObject(module, &output->object);
+        output->hasEntries = output->hasExternals = false;
+    } else {
+        formatObjectBuffer(module, &output->object);
+        formatEntries(module, &output->entries);
+        formatExternals(module, &output->externals);
+        output->hasEntries = module->entryCount > 0;
+        output->hasExternals = module->hasExternals;
+    }
+    return output->object.length + output->entries.length + output->externals.length +
+           output->relocations.length + output->lineMap.length;
+}
+
+/* Writes the output buffers next to the source file. */
+long createOutputFiles(char *sourceFileName, objectBuffers *output) {
+    char *fileName;
+    long bytes, total = 0;
+
+    fileName = changeFileExtension(sourceFileName, output->format == FORMAT_BINARY ? BINARY_OBJECT_EXTENSION : ".ob");
+    bytes = writeOutputBuffer(fileName, &output->object);
+    free(fileName);
+    if (bytes < 0) {
+        return -1;
+    }
+    total += bytes;
+
+    if (output->hasEntries) {
+        fileName = changeFileExtension(sourceFileName, ".ent");
+        bytes = writeOutputBuffer(fileName, &output->entries);
+        free(fileName);
+        if (bytes < 0) {
+            return -1;
+        }
+        total += bytes;
+    }
+
+    if (output->hasExternals) {
+        fileName = changeFileExtension(sourceFileName, ".ext");
+        bytes = writeOutputBuffer(fileName, &output->externals);
+        free(fileName);
+        if (bytes < 0) {
+            return -1;
+        }
+        total += bytes;
+    }
+
+    if (output->hasRelocations) {
+        fileName = changeFileExtension(sourceFileName, ".rel");
+        bytes = writeOutputBuffer(fileName, &output->relocations);
+        free(fileName);
+        if (bytes < 0) {
+            return -1;
+        }
+        total += bytes;
+    }
+
+    if (output->hasLineMap) {
+        fileName = changeFileExtension(sourceFileName, ".map");
+        bytes = writeOutputBuffer(fileName, &output->lineMap);
+        free(fileName);
+        if (bytes < 0) {
+            return -1;
+        }
+        total += bytes;
+    }
+    return total;
+}
+
+/* Frees the output buffers. */
+void freeObjectBuffers(objectBuffers *output) {
+    freeByteBuffer(&output->object);
+    freeByteBuffer(&output->entries);
+    freeByteBuffer(&output->externals);
+    freeByteBuffer(&output->relocations);
+    freeByteBuffer(&output->lineMap);
 }
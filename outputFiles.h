@@ -1,8 +1,30 @@
 #ifndef OUTPUTFILES_H
 #define OUTPUTFILES_H
 
+#include <stdbool.h>
+
+#include "assembler.h"
+#include "byteBuffer.h"
+#include "memory.h"
 #include "symbolTable.h"
-#include "external.h"
+#include "fixups.h"
+#include "objectFile.h"
+
+#define BINARY_OBJECT_EXTENSION ".bin"
+
+/* Structure holding the output files of an assembled source in memory. */
+typedef struct {
+    int format;               /* FORMAT_TEXT or FORMAT_BINARY */
+    byteBuffer object;        /* The text of the .ob file, or the binary object image */
+    byteBuffer entries;       /* The text of the .ent file */
+    byteBuffer externals;     /* The text of the .ext file */
+    byteBuffer relocations;   /* The text of the .rel file */
+    byteBuffer lineMap;       /* The text of the .map file */
+    bool hasEntries;          /* Whether the .ent file is created */
+    bool hasExternals;        /* Whether the .ext file is created, even when it is empty */
+    bool hasRelocations;      /* Whether the .rel file is created, even when it is empty */
+    bool hasLineMap;          /* Whether the .map file is created, even when it is empty */
+} objectBuffers;
 
 /* Changes the file extension of the given file name.
  * The caller is responsible for freeing the allocated memory
@@ -14,39 +36,143 @@ char *changeFileExtension(char *fileName, char *newExtension);
 
 /* Creates an object file with machine code and data sections. */
 /*
+ * The text is formatted by formatObjectBuffer and written the way the assembler writes it.
+ *
  * @param filename The name of the object file to create.
- * @param Ilist The list of instructions to write.
- * @param Dlist The list of data to write.
- * @param codeLength The length of the code section.
- * @param dataLength The length of the data section.
+ * @param module The words to write.
+ * @return The number of bytes written, -1 if the file could not be written.
+ */
+long createObjectFile(char *filename, objectModule *module);
+
+/* Appends the text of the .ob file of a module to a buffer. */
+/*
+ * The size of every record is known before it is formatted, so the buffer is grown once
+ * and the records are formatted straight into it, split between threads.
+ *
+ * @param module The words to format.
+ * @param buffer The buffer receiving the text.
+ */
+void formatObjectBuffer(objectModule *module, byteBuffer *buffer);
+
+/* Appends the text of the .ent file of a module to a buffer. */
+/*
+ * @param module The module holding the entry symbols.
+ * @param buffer The buffer receiving the text.
+ */
+void formatEntries(objectModule *module, byteBuffer *buffer);
+
+/* Appends the text of the .ext file of a module to a buffer. */
+/*
+ * @param module The module holding the references to external symbols.
+ * @param buffer The buffer receiving the text.
+ */
+void formatExternals(objectModule *module, byteBuffer *buffer);
+
+/* Appends the text of the .rel file of a module to a buffer. */
+/*
+ * The .rel file lists the address of every relocatable word, one per line in
+ * increasing order: the words holding the address of a label of the module, which
+ * have to move with the module when it is loaded at another base.
+ *
+ * @param module The module holding the words.
+ * @param buffer The buffer receiving the text.
+ */
+void formatRelocations(objectModule *module, byteBuffer *buffer);
+
+/* Appends the text of the .map file of a module to a buffer. */
+/*
+ * Each line of the .map file holds a code address and the source line whose words
+ * start there; the words up to the next address belong to the same source line.
+ *
+ * @param module The module holding the line records.
+ * @param buffer The buffer receiving the text.
+ */
+void formatLineMap(objectModule *module, byteBuffer *buffer);
+
+/* Writes a buffer to a file. */
+/*
+ * @param filename The name of the file to create.
+ * @param buffer The bytes to write.
+ * @return The number of bytes written, -1 if the file could not be written.
  */
-void createObjectFile(char *filename, instructionList *Ilist, dataList *Dlist, int codeLength, int dataLength);
+long writeOutputBuffer(char *filename, byteBuffer *buffer);
 
 /* Creates a file listing all entry symbols with their addresses. */
 /*
  * @param filename The name of the entries file to create.
- * @param symTable The symbol table containing symbols and their properties.
+ * @param module The module holding the entry symbols.
+ * @return The number of bytes written, 0 if the file was not created, -1 if it could not be written.
  */
-void cerateEntriesFile(char *filename, symbolTable *symTable);
+long cerateEntriesFile(char *filename, objectModule *module);
 
 /* Creates a file listing all external symbols used in the program. */
 /*
  * @param filename The name of the externals file to create.
- * @param symTable The symbol table containing symbols and their properties.
- * @param Ilist The list of instructions to write.
- * @param extArray The array of external symbols.
+ * @param module The module holding the references to external symbols.
+ * @return The number of bytes written, 0 if the file was not created, -1 if it could not be written.
+ */
+long cerateExternalsFile(char *filename, objectModule *module);
+
+/* Creates a file listing the address of every relocatable word of a module. */
+/*
+ * @param filename The name of the relocation file to create.
+ * @param module The module holding the words.
+ * @return The number of bytes written, -1 if it could not be written.
  */
-void cerateExternalsFile(char *filename, instructionList *Ilist, ExternalSymbolArray *extArray);
+long createRelocationFile(char *filename, objectModule *module);
 
-/* Creates all necessary output files for the assembler. */
+/* Collects the words, the entries and the external references of an assembled file. */
 /*
- * @param sourceFileName The source file name without extension.
- * @param Ilist The list of instructions.
- * @param Dlist The list of data.
- * @param codeLength The length of the code section.
- * @param dataLength The length of the data section.
+ * The module refers to the words of the segments, they are not copied.
+ *
+ * @param code The code segment.
+ * @param data The data segment.
+ * @param codeLength The address of the first data word.
  * @param symTable The symbol table containing symbols and their properties.
+ * @param fixups The resolved fixups, holding the references to external symbols.
+ * @param module Receives the output of the file.
+ */
+void buildObjectModule(codeSegment *code, dataSegment *data, int codeLength, symbolTable *symTable,
+                       fixupList *fixups, objectModule *module);
+
+/* Creates the .ob, .ent and .ext files of a module. */
+/*
+ * @param fileName The file name whose extension is replaced.
+ * @param module The module to write.
+ * @return The total number of bytes written, -1 if a file could not be written.
+ */
+long createTextObjectFiles(char *fileName, objectModule *module);
+
+/* Initializes empty output buffers. */
+/*
+ * @param output The buffers to initialize.
+ */
+void initObjectBuffers(objectBuffers *output);
+
+/* Formats the output files of a module into memory. */
+/*
+ * The buffers are emptied first and keep their memory, so they can be reused for every file.
+ *
+ * @param module The module to format.
+ * @param options objectFormat selects the .ob, .ent and .ext files or one binary object file;
+ *                writeRelocations and writeLineMap add the .rel and .map files, in either format.
+ * @param output Receives the files.
+ * @return The total number of bytes formatted.
+ */
+long formatObjectBuffers(objectModule *module, const assemblerOptions *options, objectBuffers *output);
+
+/* Writes the output buffers next to the source file. */
+/*
+ * @param sourceFileName The source file name, whose extension is replaced.
+ * @param output The files formatted by formatObjectBuffers.
+ * @return The total number of bytes written, -1 if a file could not be written.
+ */
+long createOutputFiles(char *sourceFileName, objectBuffers *output);
+
+/* Frees the output buffers. */
+/*
+ * @param output The buffers to free.
  */
-void createOutputFiles(char *sourceFileName, instructionList *Ilist, dataList *Dlist, int codeLength, int dataLength, symbolTable *symTable);
+void freeObjectBuffers(objectBuffers *output);
 
 #endif
@@ -2,207 +2,152 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "allocation.h"
 #include "header.h"
-#include "macro.h"
-
-/* Array of instruction names */
-const char *instructions[] = {
-    "mov", "cmp", "add", "sub", "lea", "clr", "not", "inc",
-    "dec", "jmp", "bne", "red", "prn", "jsr", "rts", "stop"
-};
-
-/* Array of directive names */
-const char *directives[] = {
-    ".data", ".string", ".entry", ".extern"
-};
-
-/* Check if a given name is a valid instruction */
-bool isInstruction(char *name) {
-    int i;
-    for (i = 0; i < sizeof(instructions) / sizeof(instructions[0]); i++) {
-        if (strcmp(name, instructions[i]) == 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
-/* Check if a given name is a valid directive */
-bool isDirective(char *name) {
-    int i;
-    for (i = 0; i < sizeof(directives) / sizeof(directives[0]); i++) {
-        if (strcmp(name, directives[i]) == 0) {
-            return true;
-        }
-    }
-    return false;
-}
+#include "keywords.h"
+#include "preProcessor.h"
+#include "processorUtils.h"
 
+#define INITIAL_PROGRAM_LINES 256
 
 /* Handle macro definition and store its lines */
-bool handleMacro(FILE *sourceFile, macro **macroList, char *macroName) {
-    char line[MAX_LINE_LENGTH + 1];
+bool handleMacro(tokenStream *tokens, int *next, macroTable *macros, span macroName, assemblerStats *stats,
+                 diagnosticList *diagnostics) {
+    span line;
+    macro *newMacro;
 
     /* Validate macro name */
     if (!isValidMacroName(macroName)) {
-        fprintf(stderr, "Invalid macro name: %s\n", macroName);
+        reportError(diagnostics, "Invalid macro name: %.*s", macroName.length, macroName.start);
         return false;
     }
 
-    /* Add macro to macro list */
-    addMacro(macroList, macroName);
+    /* Add macro to macro table */
+    newMacro = addMacro(macros, macroName);
+    stats->macrosDefined++;
 
     /* Read lines until "endmacr" is encountered */
-    while (fgets(line, sizeof(line), sourceFile)) {
-        char end_macro[MAX_MACRO_NAME];
+    while (*next < tokens->lineCount) {
+        line = lexedLineSpan(tokens, *next);
+        stats->linesRead++;
+        diagnostics->line = (int) stats->linesRead;
 
         /* Check for end of macro */
-        if (sscanf(line, "%s", end_macro) == 1 && strcmp(end_macro, "endmacr") == 0) {
+        if (keywordOf(lexedWordSpan(tokens, (*next)++, 0)) == KEYWORD_ENDMACR) {
             return true;
         }
 
         /* Check for line length exceeding limit */
-        if (strlen(line) > MAX_LINE_LENGTH) {
-            fprintf(stderr, "Macro line too long: %s\n", line);
+        if (line.length > MAX_LINE_LENGTH) {
+            reportError(diagnostics, "Macro line too long: %.*s", line.length, line.start);
             return false;
         }
 
         /* Add line to macro's line list */
-        addMacroLine(*macroList, line);
+        addMacroLine(newMacro, *next - 1);
     }
     return false;
 }
 
-/* Add a line to the end of a linked list of code lines */
-void addLine(codeLine **head, char *line) {
-    codeLine *newLine;
-
-    newLine = malloc(sizeof(codeLine));
-    if (newLine == NULL) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(EXIT_FAILURE);
-    }
-
-    newLine->line = malloc(strlen(line) + 1);
-    if (newLine->line == NULL) {
-        fprintf(stderr, "Memory allocation failed for line\n");
-        free(newLine);
-        exit(EXIT_FAILURE);
-    }
-
-    strcpy(newLine->line, line);
-    newLine->next = NULL;
-
-    /* Append new line to the end of the list */
-    if (*head == NULL) {
-        *head = newLine;
-    } else {
-        codeLine *current;
-        current = *head;
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = newLine;
-    }
+/* Initialize an empty expanded program */
+void initExpandedProgram(expandedProgram *program, byteBuffer *expandedText) {
+    program->tokens = NULL;
+    program->lines = NULL;
+    program->sourceLines = NULL;
+    program->count = 0;
+    program->capacity = 0;
+    program->expandedText = expandedText;
 }
 
-/* Write expanded code lines to an output file */
-bool writeExpandedFile(codeLine *codeList, FILE *outputFile, char *outputFileName) {
-    codeLine *current;
-
-    outputFile = fopen(outputFileName, "w");
-    if (outputFile == NULL) {
-        fprintf(stderr, "Error creating output file: %s\n", outputFileName);
-        return false;
+/* Collect an expanded line in memory, and append it to the text of the .am file when it is kept */
+void collectExpandedLine(const tokenStream *tokens, int line, int sourceLine, void *context) {
+    expandedProgram *program = (expandedProgram *) context;
+    span text;
+
+    /* Grow the arrays of lines geometrically */
+    if (program->count == program->capacity) {
+        int capacity = program->capacity ? 2 * program->capacity : INITIAL_PROGRAM_LINES;
+        program->lines = reallocateMemory(program->lines, sizeof(int) * capacity);
+        program->sourceLines = reallocateMemory(program->sourceLines, sizeof(int) * capacity);
+        program->capacity = capacity;
     }
-
-    current = codeList;
-    while (current != NULL) {
-        fprintf(outputFile, "%s", current->line);
-        current = current->next;
+    program->tokens = tokens;
+    program->lines[program->count] = line;
+    program->sourceLines[program->count++] = sourceLine;
+
+    if (program->expandedText != NULL) {
+        char *end;
+        text = lexedLineSpan(tokens, line);
+        end = extendByteBuffer(program->expandedText, text.length + 1);
+        memcpy(end, text.start, text.length);
+        end[text.length] = '\n';
     }
-
-    fclose(outputFile);
-    return true;
 }
 
-/* Checks if a given line contains a macro definition. */
-bool isMacroLine(char *line) {
-    char macro[MAX_MACRO_NAME];
-    if (sscanf(line, "%4s", macro) == 1) {
-        if (strcmp(macro, "macr") == 0) {
-            return true;
-        }
-    }
-    return false;
+/* Free the lines of an expanded program */
+void freeExpandedProgram(expandedProgram *program) {
+    free(program->lines);
+    free(program->sourceLines);
+    program->lines = NULL;
+    program->sourceLines = NULL;
+    program->count = program->capacity = 0;
 }
 
-/* Removes the "macr" keyword from the beginning of the line. */
-void removeMacrFromLine(char *line) {
-    char *temp;
+/* Expand macros in the source text, handing each expanded line to the consumer */
+bool expandMacros(sourceBuffer *source, tokenStream *tokens, macroTable *macros, lineConsumer consumer,
+                  void *context, assemblerStats *stats, diagnosticList *diagnostics) {
+    int next = 0, current;
+    span line, currentWord;
+    bool success = true;
 
-    temp = strchr(line, 'r');
-    if (temp) {
-        strcpy(line, ++temp);
-    }
-}
+    /* Split the whole text into lines and words at once */
+    lexSource(source, tokens);
 
-/* Expand macros in the source file and write expanded code to an output file */
-bool expandMacros(FILE *sourceFile, FILE *outputFile, char *outputFileName) {
-    macro *macroList = NULL;
-    codeLine *codeList = NULL;
-    char line[MAX_LINE_LENGTH + 2];
-    char currentWord[MAX_MACRO_NAME];
-
-    /* Read each line from the source file */
-    while (fgets(line, sizeof(line), sourceFile)) {
+    /* Read each line from the source text */
+    while (success && next < tokens->lineCount) {
         int i;
-        char macroName[MAX_MACRO_NAME];
+        span macroName;
+        current = next++;
+        line = lexedLineSpan(tokens, current);
+        stats->linesRead++;
+        diagnostics->line = (int) stats->linesRead;
 
         /* Check for line length exceeding limit */
-        if (strlen(line) > MAX_LINE_LENGTH + 1) {
-            fprintf(stderr, "Error: Line too long: %s\n", line);
-            return false;
+        if (line.length > MAX_LINE_LENGTH) {
+            reportError(diagnostics, "Error: Line too long: %.*s", line.length, line.start);
+            success = false;
+            break;
         }
 
-        /* Read the first word from the line */
-        sscanf(line, "%s", currentWord);
+        /* Read the first word from the line, an empty line has none */
+        currentWord = lexedWordSpan(tokens, current, 0);
 
         /* Handle macro definition */
-        if ( isMacroLine(line) ) {
-            removeMacrFromLine(line);
+        if (keywordOf(currentWord) == KEYWORD_MACR) {
             /* Extract macro name */
-            if (sscanf(line , "%s", macroName) != 1) {
-                fprintf(stderr, "Invalid macro definition line: %s\n", line);
-                return false;
+            macroName = lexedWordSpan(tokens, current, 1);
+            if (macroName.length == 0) {
+                reportError(diagnostics, "Invalid macro definition line: %.*s", line.length, line.start);
+                success = false;
             }
 
             /* Process and store the macro */
-            if (!handleMacro(sourceFile, &macroList, macroName)) {
-                fprintf(stderr, "Handling macro failed: %s\n", macroName);
-                return false;
+            else if (!handleMacro(tokens, &next, macros, macroName, stats, diagnostics)) {
+                reportError(diagnostics, "Handling macro failed: %.*s", macroName.length, macroName.start);
+                success = false;
             }
         } else {
-            /* Expand macros or add regular lines to code list */
-            macro *macro = findMacro(macroList, currentWord);
+            /* Expand macros or pass regular lines on as they are */
+            macro *macro = findMacro(macros, currentWord);
             if (macro) {
-                /* Add expanded macro lines to code list */
+                stats->macrosExpanded++;
                 for (i = 0; i < macro->lineCount; i++) {
-                    addLine(&codeList, macro->lines[i]);
+                    consumer(tokens, macro->lines[i], diagnostics->line, context);
                 }
             } else {
-                addLine(&codeList, line);
+                consumer(tokens, current, diagnostics->line, context);
             }
         }
     }
-
-    /* Write expanded code to output file */
-    if (!writeExpandedFile(codeList, outputFile, outputFileName)) {
-        return false;
-    }
-
-    /* Clean up allocated memory */
-    freeMacros(macroList);
-    freeLines(codeList);
-    return true;
+    return success;
 }
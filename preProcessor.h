@@ -2,21 +2,79 @@
 #define PREPROCESSOR_H
 #include <stdbool.h>
 
+#include "byteBuffer.h"
+#include "diagnostics.h"
+#include "header.h"
+#include "lexer.h"
+#include "macro.h"
+#include "sourceReader.h"
+#include "statistics.h"
+
+/* Function receiving the expanded lines one at a time, in order, as lines of the token stream
+ * of the source, with the number of the source line they come from: the line of the macro
+ * call for the lines of a macro. */
+typedef void (*lineConsumer)(const tokenStream *tokens, int line, int sourceLine, void *context);
+
+/* Structure collecting the expanded program in memory. */
+typedef struct {
+    const tokenStream *tokens; /* The token stream of the source the lines come from */
+    int *lines;               /* The expanded lines, by their number in the token stream */
+    int *sourceLines;         /* The source line of each expanded line */
+    int count;                /* Number of expanded lines */
+    int capacity;             /* Number of lines the arrays can hold */
+    byteBuffer *expandedText; /* Receives the text of the .am file, or NULL */
+} expandedProgram;
+
+/*
+ * Expands macros in the source text, streaming the expanded lines to a consumer.
+ *
+ * This function processes the source text to replace macros with their
+ * definitions. The text is first split into lines and words by lexSource, in one
+ * sweep; each expanded line is then handed to the consumer as soon as it is
+ * known, so the expander itself never keeps the whole program. Lines are never
+ * copied: a line and the lines of a macro are lines of the token stream, which
+ * point into the source text, and both must stay as they are as long as the
+ * lines are used. Macros are looked up through a hash table.
+ *
+ * @param source      The source text to be processed. It should contain the code
+ *                    with macros to be expanded.
+ * @param tokens      Receives the lines and the words of the source text.
+ * @param macros      Receives the macros defined in the source; the caller frees it.
+ * @param consumer    The function that receives each expanded line.
+ * @param context     Passed to the consumer with every line.
+ * @param stats       Counts the lines read and the macros defined and expanded.
+ * @param diagnostics Receives the errors, on the source line they were found.
+ *
+ * @return Returns `true` if the expansion was successful. Returns `false` otherwise.
+ */
+bool expandMacros(sourceBuffer *source, tokenStream *tokens, macroTable *macros, lineConsumer consumer,
+                  void *context, assemblerStats *stats, diagnosticList *diagnostics);
+
+/*
+ * Initializes an empty expanded program.
+ *
+ * @param program The program to initialize.
+ * @param expandedText The buffer receiving the text of the .am file, or NULL.
+ */
+void initExpandedProgram(expandedProgram *program, byteBuffer *expandedText);
+
 /*
- * Expands macros in the source file and writes the result to the output file.
+ * Line consumer that appends each expanded line to an expandedProgram.
  *
- * This function processes the source file to replace macros with their
- * definitions and writes the expanded content to the output file.
+ * When the program keeps the text of the .am file, the line is appended to it as well.
  *
- * @param source_file A pointer to the source file to be processed. This file should
- *                    contain the code with macros to be expanded.
- * @param output_file A pointer to the output file where the expanded code will be written.
- * @param file_name   A string containing the name of the source file. This is used for
- *                    error reporting or debugging purposes.
+ * @param tokens The token stream of the source.
+ * @param line The number of the expanded line in the token stream.
+ * @param sourceLine The number of the source line the line comes from.
+ * @param context A pointer to the expandedProgram.
+ */
+void collectExpandedLine(const tokenStream *tokens, int line, int sourceLine, void *context);
+
+/*
+ * Frees the lines of an expanded program. The text of the .am file is not freed.
  *
- * @return Returns `true` if the expansion was successful and the output file was written
- *         without errors. Returns `false` otherwise.
+ * @param program The program to free.
  */
-bool expandMacros(FILE *source_file, FILE *output_file, char *);
+void freeExpandedProgram(expandedProgram *program);
 
 #endif
@@ -5,210 +5,156 @@
 #include <string.h>
 
 #include "header.h"
+#include "keywords.h"
+#include "processorUtils.h"
 
 
-/* Check if the line is an instruction line */
-bool isInstructionLine(char *line) {
-    char word[MAX_LINE_LENGTH];
-    if (sscanf(line, "%s", word)) {
-        return isInstruction(word);
-    }
-    return false;
+/* Hash a name (FNV-1a) */
+unsigned long hashString(const char *s, size_t length) {
+    return continueHash(HASH_OFFSET_BASIS, s, length);
 }
 
-/* Check if the line is a directive line */
-bool isDirectiveLine(char *line) {
-    char word[MAX_LINE_LENGTH];
-    if (sscanf(line, "%s", word)) {
-        return isDirective(word);
+/* Continue a hash over more characters */
+unsigned long continueHash(unsigned long hash, const char *s, size_t length) {
+    while (length--) {
+        hash ^= (unsigned char) *s++;
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
     }
-    return false;
-}
-
-/* Check if the line is a comment line (starts with ';') */
-bool isNoteLine(char *s) {
-    return s[0] == ';';
+    return hash;
 }
 
-/* Check if the line is empty (contains only whitespace) */
-bool isEmptyLine(char *s) {
-    int i;
-    for (i = 0; i < strlen(s); i++) {
-        if (!isspace(s[i])) {
-            return false;
-        }
+/* Skip left white spaces in a span */
+span trimLeft(span s) {
+    while (s.length > 0 && isspace((unsigned char) *s.start)) {
+        s.start++;
+        s.length--;
     }
-    return true;
+    return s;
 }
 
-/* Array of registers names */
-char *registers[REGISTERS] = {
-    "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7"
-};
-
-/* Validate direct addressing method */
-bool isDirectRegister(char *s) {
-    int i;
-    for (i = 0; i < REGISTERS; i++) {
-        if (strcmp(s, registers[i]) == 0) {
-            return true;
-        }
+/* Skip white spaces on both sides of a span */
+span trimSpan(span s) {
+    s = trimLeft(s);
+    while (s.length > 0 && isspace((unsigned char) s.start[s.length - 1])) {
+        s.length--;
     }
-    return false;
+    return s;
 }
 
-/* Validate indirect addressing method */
-bool isInDirectRegister(char *s) {
-    if (s[0] == '*') {
-        return isDirectRegister(s + 1);
-    }
-    return false;
-}
-
-/* Validate register (direct or indirect) */
-bool isRegister(char *s) {
-    return isDirectRegister(s) || isInDirectRegister(s);
-}
+/* Return the first word of a line */
+span firstWord(span line) {
+    span word = trimLeft(line);
+    int length = 0;
 
-
-/* Check if the line contains a symbol */
-bool isSymbol(char *line, char *symbol) {
-    sscanf(line, "%s", symbol);
-
-    if (symbol[strlen(symbol) - 1] == ':') {
-        symbol = strtok(symbol, ":");  /* For adding symbol to symbolTable without the colon */
-        return true;
+    while (length < word.length && !isspace((unsigned char) word.start[length])) {
+        length++;
     }
-    return false;
+    word.length = length;
+    return word;
 }
 
-/* Check if the line is a valid label (not an instruction or directive) */
-bool isValidLabel(char *s) {
-    return !isInstruction(s) && !isDirective(s);
+/* Return the rest of the line after a part of it */
+span restOfLine(span line, span part) {
+    span rest;
+    rest.start = part.start + part.length;
+    rest.length = line.length - (int) (rest.start - line.start);
+    return rest;
 }
 
-/* Check if the line is a data or string directive (.data, .string) */
-bool isDataOrString(char *s) {
-    char word[MAX_LINE_LENGTH];
-    if (sscanf(s, "%s", word)) {
-        if (strcmp(word, ".data") == 0 || strcmp(word, ".string") == 0) {
-            return true;
-        }
-    }
-    return false;
+/* Take the next whitespace separated word from a line */
+bool nextWord(span *rest, span *word) {
+    *word = firstWord(*rest);
+    *rest = restOfLine(*rest, *word);
+    return word->length > 0;
 }
 
-/* Check if the line is an external directive (.extern) */
-bool isExternalLine(const char *s) {
-    char word[MAX_LINE_LENGTH];
-    if (sscanf(s, "%s", word) == 1) {
-        return strcmp(word, ".extern") == 0;
-    }
-    return false;
-}
+/* Take the next field from a line of fields divided by a separator */
+bool nextField(span *rest, char separator, span *field) {
+    const char *end;
 
-/* Validate numeric character with possible '+' or '-' sign */
-bool isNumeric(const char *str) {
-    if (str == NULL || *str == '\0') {
+    if (rest->start == NULL || rest->length < 0) {
         return false;
     }
-    if (*str == '+' || *str == '-') {
-        str++;
-    }
-    while (*str) {
-        if (!isdigit(*str) && !isspace(*str)) {
-            return false;
-        }
-        str++;
+
+    field->start = rest->start;
+    end = memchr(rest->start, separator, rest->length);
+    if (end == NULL) {
+        field->length = rest->length;
+        rest->start = NULL;  /* This was the last field */
+    } else {
+        field->length = (int) (end - rest->start);
+        rest->start = end + 1;
+        rest->length -= field->length + 1;
     }
     return true;
 }
 
-/* Skip left white spaces in line */
-void ignoreLeftWhiteSpaces(char *s) {
-    char *temp;
-    if (s == NULL || *s == '\0') {
-        return;
-    }
-
-    temp = s;
-    while (isspace(*temp)) { temp++; }
-    strcpy(s, temp);
+/* Return the keyword ID of a word */
+int keywordOf(span word) {
+    return findKeywordSpan(word.start, word.length);
 }
 
-/* Remove symbol from line */
-void removeSymbolFromLine(char *line) {
-    char *temp;
-    temp = strchr(line, ':');
-    strcpy(line, ++temp); /* Skip the colon */
+/* Check if the line is a comment line (starts with ';') */
+bool isNoteLine(span s) {
+    return s.length > 0 && s.start[0] == ';';
 }
 
-/* Remove directive from the line (e.g., ".data") */
-void removeDirectiveFromLine(char *line) {
-    char *temp;
-    temp = strchr(line, '.');
-    while (!isspace(*temp)) { temp++; }
-    ignoreLeftWhiteSpaces(temp);
-    strcpy(line, temp);
-}
 
-/* Returns number of operands that given operation requires */
-int estimatedOperands(char *name) {
-    if (strcmp(name, "mov") == 0 || strcmp(name, "cmp") == 0 || strcmp(name, "add") == 0 || strcmp(name, "sub") == 0 ||
-        strcmp(name, "lea") == 0) {
-        return 2;
-    }
-    if (strcmp(name, "clr") == 0 || strcmp(name, "not") == 0 || strcmp(name, "inc") == 0 || strcmp(name, "dec") == 0 ||
-        strcmp(name, "jmp") == 0 || strcmp(name, "bne") == 0 || strcmp(name, "red") == 0 || strcmp(name, "prn") == 0 ||
-        strcmp(name, "jsr") == 0) {
-        return 1;
+/* Check if a word is a symbol definition (ends with ':') */
+bool isSymbol(span word, span *symbol) {
+    if (word.length > 0 && word.start[word.length - 1] == ':') {
+        /* For adding symbol to symbolTable without the colon */
+        *symbol = word;
+        symbol->length = (int) ((const char *) memchr(word.start, ':', word.length) - word.start);
+        return true;
     }
-    return 0;
+    return false;
+}
+
+/* Check if the symbol is a valid label (not an instruction or directive) */
+bool isValidLabel(span s) {
+    int id = keywordOf(s);
+    return s.length > 0 && !IS_OPERATION(id) && !IS_DIRECTIVE(id);
 }
 
 /* Count the number of commas in a line */
-int expectedCommas(char *line) {
-    int commas = 0;
-    char *temp = strchr(line, ',');
-    while (temp != NULL) {
-        commas++;
-        temp = strchr(temp + 1, ',');
+int expectedCommas(span line) {
+    int i, commas = 0;
+    for (i = 0; i < line.length; i++) {
+        commas += line.start[i] == ',';
     }
     return commas;
 }
 
 
-/* Validate and format operands in a line */
-bool validateOperands(int estOperands, char *line, char **sourceOperand, char **destOperand) {
+/* Validate and split the operands of an instruction */
+bool validateOperands(int estOperands, span line, span *sourceOperand, span *destOperand,
+                      diagnosticList *diagnostics) {
     int operands = 0;
-    char *token;
+    span field;
 
-    token = strtok(line, ",\n");
+    sourceOperand->start = NULL;
+    destOperand->start = NULL;
+    sourceOperand->length = destOperand->length = 0;
 
-    while (token) {
-        ignoreLeftWhiteSpaces(token);
+    while (nextField(&line, ',', &field)) {
+        field = trimSpan(field);
 
-        if (!isEmptyLine(token + strlen(token))) {
-            fprintf(stderr, "Error - Comma expected\n");
-            return false;
+        /* Empty fields are skipped, the count of operands tells if one is missing */
+        if (field.length == 0) {
+            continue;
         }
 
         operands++;
 
-        if (estOperands == 1) {
-            *destOperand = token;
+        if (estOperands == 1 || operands > 1) {
+            *destOperand = field;
         } else {
-            if (operands == 1) {
-                *sourceOperand = token;
-            } else {
-                *destOperand = token;
-                ignoreLeftWhiteSpaces(*destOperand);
-            }
+            *sourceOperand = field;
         }
-        token = strtok(NULL, ",\n");
     }
     if (operands > estOperands) {
-        fprintf(stderr, "Error - too many operands\n");
+        reportError(diagnostics, "Error - too many operands");
         return false;
     }
 
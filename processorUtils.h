@@ -1,150 +1,118 @@
-
 #ifndef PROCESSORUTILS_H
 #define PROCESSORUTILS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
-/* Check if the line is an instruction line.
- *
- * This function checks if the given line starts with an instruction.
- *
- * @param line The line to check.
- * @return true if the line is an instruction line, false otherwise.
- */
-bool isInstructionLine(char *line);
-
-/* Check if the line is a directive line.
- *
- * This function checks if the given line starts with a directive.
- *
- * @param line The line to check.
- * @return true if the line is a directive line, false otherwise.
- */
-bool isDirectiveLine(char *line);
-
-/* Check if the line is a comment line (starts with ';').
- *
- * This function checks if the given line starts with a comment character.
- *
- * @param s The line to check.
- * @return true if the line is a comment line, false otherwise.
- */
-bool isNoteLine(char *s);
+#include "diagnostics.h"
+#include "header.h"
 
-/* Check if the line is empty (contains only whitespace).
- *
- * This function checks if the given line contains only whitespace characters.
- *
- * @param s The line to check.
- * @return true if the line is empty, false otherwise.
- */
-bool isEmptyLine(char *s);
+#define HASH_OFFSET_BASIS 2166136261UL  /* The hash of no characters */
 
-/* Validate direct addressing method.
+/* Hash a name for the symbol and macro tables.
  *
- * This function checks if the given string represents a valid direct register.
+ * This function computes the 32 bit FNV-1a hash of the given characters.
  *
- * @param s The string to check.
- * @return true if the string represents a valid direct register, false otherwise.
+ * @param s The characters to hash.
+ * @param length The number of characters.
+ * @return The hash value.
  */
-bool isDirectRegister(char *s);
+unsigned long hashString(const char *s, size_t length);
 
-/* Validate indirect addressing method.
+/* Continue a hash over more characters.
  *
- * This function checks if the given string represents a valid indirect register.
+ * Hashing a text in parts from HASH_OFFSET_BASIS gives the hashString of the whole text.
  *
- * @param s The string to check.
- * @return true if the string represents a valid indirect register, false otherwise.
+ * @param hash The hash of the characters before these.
+ * @param s The characters to hash.
+ * @param length The number of characters.
+ * @return The hash value.
  */
-bool isInDirectRegister(char *s);
+unsigned long continueHash(unsigned long hash, const char *s, size_t length);
 
-/* Validate register (direct or indirect).
+/* Skip left white spaces in a span.
  *
- * This function checks if the given string represents a valid register, either direct or indirect.
- *
- * @param s The string to check.
- * @return true if the string represents a valid register, false otherwise.
+ * @param s The span to process.
+ * @return The span without its leading whitespace.
  */
-bool isRegister(char *s);
+span trimLeft(span s);
 
-/* Check if the line contains a symbol.
- *
- * This function checks if the given line contains a symbol and extracts it.
+/* Skip white spaces on both sides of a span.
  *
- * @param line The line to check.
- * @param symbol The symbol extracted from the line.
- * @return true if a symbol is found, false otherwise.
+ * @param s The span to process.
+ * @return The span without its leading and trailing whitespace.
  */
-bool isSymbol(char *line, char *symbol);
+span trimSpan(span s);
 
-/* Check if the line is a valid label (not an instruction or directive).
+/* Return the first word of a line.
  *
- * This function checks if the given line is a valid label that is neither an instruction nor a directive.
+ * A word is a run of characters that are not whitespace.
  *
- * @param s The line to check.
- * @return true if the line is a valid label, false otherwise.
+ * @param line The line to process.
+ * @return The first word, empty if the line is empty.
  */
-bool isValidLabel(char *s);
+span firstWord(span line);
 
-/* Check if the line is a data or string directive (.data, .string).
+/* Return the rest of the line after a part of it.
  *
- * This function checks if the given line is a data or string directive.
- *
- * @param s The line to check.
- * @return true if the line is a data or string directive, false otherwise.
+ * @param line The line.
+ * @param part A span inside the line.
+ * @return The characters of the line that follow the part.
  */
-bool isDataOrString(char *s);
+span restOfLine(span line, span part);
 
-/* Check if the line is an external directive (.extern).
- *
- * This function checks if the given line is an external directive.
+/* Take the next whitespace separated word from a line.
  *
- * @param s The line to check.
- * @return true if the line is an external directive, false otherwise.
+ * @param rest The part of the line not read yet; the word is removed from it.
+ * @param word Receives the word.
+ * @return true if there was a word, false otherwise.
  */
-bool isExternalLine(const char *s);
+bool nextWord(span *rest, span *word);
 
-/* Validate numeric character with possible '+' or '-' sign.
- *
- * This function checks if the given string represents a valid numeric value.
+/* Take the next field from a line of fields divided by a separator.
  *
- * @param str The string to check.
- * @return true if the string represents a valid numeric value, false otherwise.
+ * @param rest The part of the line not read yet; the field and its separator are removed from it.
+ * @param separator The character dividing the fields.
+ * @param field Receives the field, which may be empty.
+ * @return true if there was a field, false at the end of the line.
  */
-bool isNumeric(const char *str);
+bool nextField(span *rest, char separator, span *field);
 
-/* Skip left white spaces in line.
+/* Return the keyword ID of a word.
  *
- * This function removes leading whitespace characters from the given line.
- *
- * @param s The line to process.
+ * @param word The word to look up.
+ * @return The keyword ID, or KEYWORD_NONE.
  */
-void ignoreLeftWhiteSpaces(char *s);
+int keywordOf(span word);
 
-/* Remove symbol from line.
+/* Check if the line is a comment line (starts with ';').
  *
- * This function removes the symbol from the beginning of the given line.
+ * This function checks if the given line starts with a comment character.
  *
- * @param line The line to process.
+ * @param s The line to check.
+ * @return true if the line is a comment line, false otherwise.
  */
-void removeSymbolFromLine(char *line);
+bool isNoteLine(span s);
 
-/* Remove directive from the line (e.g., ".data").
+/* Check if a word is a symbol definition (ends with ':').
  *
- * This function removes the directive from the beginning of the given line.
+ * This function checks if the given word defines a symbol and extracts the symbol.
  *
- * @param line The line to process.
+ * @param word The first word of a line.
+ * @param symbol Receives the symbol, without the colon.
+ * @return true if a symbol is found, false otherwise.
  */
-void removeDirectiveFromLine(char *line);
+bool isSymbol(span word, span *symbol);
 
-/* Returns number of operands that given operation requires.
+/* Check if the symbol is a valid label (not an instruction or directive).
  *
- * This function returns the number of operands required by the given operation.
+ * This function checks if the given symbol is neither an instruction nor a directive.
+ * A label too long for the symbol table is cut by internName.
  *
- * @param name The name of the operation.
- * @return The number of operands required.
+ * @param s The symbol to check.
+ * @return true if the symbol is a valid label, false otherwise.
  */
-int estimatedOperands(char *name);
+bool isValidLabel(span s);
 
 /* Count the number of commas in a line.
  *
@@ -153,20 +121,21 @@ int estimatedOperands(char *name);
  * @param line The line to process.
  * @return The number of commas in the line.
  */
-int expectedCommas(char *line);
+int expectedCommas(span line);
 
-/* Validate and format operands in a line.
+/* Validate and split the operands of an instruction.
  *
- * This function validates and formats operands in the given line based on the expected number of operands.
+ * This function splits the operands at the commas and checks their number against the
+ * expected number of operands. A missing operand is returned with a NULL start.
  *
  * @param estOperands The expected number of operands.
- * @param line The line containing operands.
- * @param sourceOperand A pointer to store the source operand.
- * @param destOperand A pointer to store the destination operand.
+ * @param line The rest of the line after the operation.
+ * @param sourceOperand Receives the source operand.
+ * @param destOperand Receives the destination operand.
+ * @param diagnostics Receives the reason the operands are not valid.
  * @return true if the operands are valid, false otherwise.
  */
-bool validateOperands(int estOperands, char *line, char **sourceOperand, char **destOperand);
-
-
+bool validateOperands(int estOperands, span line, span *sourceOperand, span *destOperand,
+                      diagnosticList *diagnostics);
 
 #endif
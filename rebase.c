@@ -0,0 +1,158 @@
+/*
+ * rebase.c
+ *
+ * Description:
+ * Moves an assembled program to another load address without assembling
+ * it again. The .rel file written with --rel lists every word holding the
+ * address of a label of the program; each of them is moved by the
+ * difference between the new base and the old one, and so are the
+ * addresses of the records, of the entries and of the external references.
+ * The program is rebased in one pass over its relocation list, and its
+ * files are written again in place, or under another name.
+ *
+ * Usage:
+ *   ./rebase --base=500 prog.ob             rewrites prog.ob, .ent, .ext and .rel
+ *   ./rebase --base=500 -o moved prog.ob    writes moved.ob, .ent, .ext and .rel
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "assembler.h"
+#include "machineCode.h"
+#include "objectFile.h"
+#include "outputFiles.h"
+
+/*
+ * Moves the relocatable words listed in a relocation file.
+ * @param fileName The name of the .rel file.
+ * @param module The program, still at its old base.
+ * @param delta The distance the program moves.
+ * @return true if every listed word was moved, false if the file is missing or invalid.
+ */
+static bool relocateWords(const char *fileName, objectModule *module, int delta) {
+    int address, index, fields, moved;
+    unsigned short word;
+    FILE *file;
+
+    file = fopen(fileName, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening relocation file: %s\n", fileName);
+        return false;
+    }
+
+    while ((fields = fscanf(file, "%d", &address)) == 1) {
+        index = address - module->loadBase;
+        if (index < 0 || index >= module->codeCount || (module->code[index] & ARE_MASK) != (1 << R_BIT)) {
+            fprintf(stderr, "Error: Address %d in %s is not a relocatable word\n", address, fileName);
+            fclose(file);
+            return false;
+        }
+        word = module->code[index];
+        moved = (word >> VAL_POSITION) + delta;
+        if (moved < 0 || moved >= LABEL_ADDRESS_SPAN) {
+            fprintf(stderr, "Error: The word at %d would refer to address %d, outside the %d addresses of a word\n",
+                    address, moved, LABEL_ADDRESS_SPAN);
+            fclose(file);
+            return false;
+        }
+        module->code[index] = (unsigned short) ((moved << VAL_POSITION) | (1 << R_BIT));
+    }
+    fclose(file);
+
+    if (fields != EOF) {
+        fprintf(stderr, "Error: Invalid line in %s\n", fileName);
+    }
+    return fields == EOF;
+}
+
+/*
+ * Rebases a program and writes its files.
+ * @param objectFileName The .ob file; the .ent, .ext and .rel files are found next to it.
+ * @param outputName The name whose extension is replaced by those of the files written.
+ * @param base The new address of the first word.
+ * @return true if the program was rebased, false otherwise.
+ */
+static bool rebaseProgram(char *objectFileName, char *outputName, int base) {
+    char *entryFileName, *externalFileName, *relocationFileName;
+    objectModule module;
+    bool success;
+    int delta = 0, i;
+
+    entryFileName = changeFileExtension(objectFileName, ".ent");
+    externalFileName = changeFileExtension(objectFileName, ".ext");
+    relocationFileName = changeFileExtension(objectFileName, ".rel");
+
+    success = readTextObject(objectFileName, entryFileName, externalFileName, &module);
+    if (success && base + module.codeCount + module.dataCount > LABEL_ADDRESS_SPAN) {
+        fprintf(stderr, "Error: The program of %d words does not fit below address %d at base %d\n",
+                module.codeCount + module.dataCount, LABEL_ADDRESS_SPAN, base);
+        success = false;
+    }
+    if (success) {
+        delta = base - module.loadBase;
+        success = relocateWords(relocationFileName, &module, delta);
+    }
+    if (success) {
+        module.loadBase += delta;
+        module.dataBase += delta;
+        for (i = 0; i < module.entryCount; i++) {
+            module.entries[i].address += delta;
+        }
+        for (i = 0; i < module.externCount; i++) {
+            module.externs[i].address += delta;
+        }
+
+        free(relocationFileName);
+        relocationFileName = changeFileExtension(outputName, ".rel");
+        success = createTextObjectFiles(outputName, &module) >= 0 &&
+                  createRelocationFile(relocationFileName, &module) >= 0;
+    }
+    freeObjectModule(&module);
+
+    free(entryFileName);
+    free(externalFileName);
+    free(relocationFileName);
+    return success;
+}
+
+/*
+ * Main function of the rebase tool.
+ * @param argc The number of command-line arguments.
+ * @param argv The new base, the output name and the program to rebase.
+ * @return 0 if the program was rebased, otherwise 1.
+ */
+int main(int argc, char *argv[]) {
+    char *outputName = NULL, *end;
+    int first = 1, base = -1;
+
+    /* Parse the options given before the file name */
+    while (first < argc && argv[first][0] == '-') {
+        if (strncmp(argv[first], "--base=", 7) == 0) {
+            base = (int) strtol(argv[first] + 7, &end, 10);
+            if (argv[first][7] == '\0' || *end != '\0' || base < 0) {
+                printf("Invalid base: %s\n", argv[first] + 7);
+                return 1;
+            }
+        } else if (strcmp(argv[first], "-o") == 0 && first + 1 < argc) {
+            outputName = argv[++first];
+        } else {
+            printf("Unknown option: %s\n", argv[first]);
+            return 1;
+        }
+        first++;
+    }
+
+    if (base < 0 || argc - first != 1) {
+        printf("Usage: %s --base=<address> [-o <output>] <file.ob>\n", argv[0]);
+        return 1;
+    }
+
+    if (!rebaseProgram(argv[first], outputName != NULL ? outputName : argv[first], base)) {
+        fprintf(stderr, "Error rebasing file: %s\n", argv[first]);
+        return 1;
+    }
+    return 0;
+}
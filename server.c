@@ -0,0 +1,258 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "allocation.h"
+#include "byteBuffer.h"
+#include "server.h"
+#include "sourceReader.h"
+#include "statistics.h"
+
+/* Names of the outcomes of an assembly in the answers, by status */
+static const char *statusNames[] = {"ok", "errors", "expansion-failed", "out-of-memory"};
+
+/* Returns the next word of a request and moves past it, or NULL at the end of the request. */
+static char *nextRequestWord(char **cursor) {
+    char *word = *cursor;
+
+    while (*word == ' ') {
+        word++;
+    }
+    if (*word == '\0') {
+        *cursor = word;
+        return NULL;
+    }
+
+    /* Terminate the word in place */
+    for (*cursor = word; **cursor != ' ' && **cursor != '\0'; (*cursor)++) {
+    }
+    if (**cursor == ' ') {
+        *(*cursor)++ = '\0';
+    }
+    return word;
+}
+
+/* Returns the name the output files are named after: the name itself, or its last part in the output directory. */
+static char *outputName(const char *name, const char *directory) {
+    const char *base;
+    char *path;
+
+    if (directory == NULL) {
+        path = allocateMemory(strlen(name) + 1);
+        strcpy(path, name);
+        return path;
+    }
+
+    base = strrchr(name, '/');
+    base = base != NULL ? base + 1 : name;
+    path = allocateMemory(strlen(directory) + strlen(base) + 2);
+    sprintf(path, "%s/%s", directory, base);
+    return path;
+}
+
+/* Reads and drops the bytes of a source that is refused, returns false if the stream ends first. */
+static bool skipSourceBytes(FILE *in, long length) {
+    char discarded[BUFSIZ];
+    size_t chunk;
+
+    while (length > 0) {
+        chunk = length < (long) sizeof(discarded) ? (size_t) length : sizeof(discarded);
+        if (fread(discarded, 1, chunk, in) != chunk) {
+            return false;
+        }
+        length -= (long) chunk;
+    }
+    return true;
+}
+
+/* Answers a request that failed before anything was assembled. */
+static void answerFailure(FILE *out, const char *status, const char *message, const char *argument) {
+    fprintf(out, "status %s 1\nerror 0 %s%s\nend\n", status, message, argument);
+    fflush(out);
+}
+
+/* Assembles a source, writes its files and answers with the outcome and the errors. */
+static void assembleRequest(FILE *out, assemblerContext *context, const assemblerOptions *options,
+                            const char *source, long length, const char *name, const char *directory) {
+    assemblyResult *result = assembleBuffer(context, source, length, options);
+    const char *status = statusNames[result->status];
+    char *fileName;
+    int i;
+
+    if (result->status == ASSEMBLY_SUCCESS || result->status == ASSEMBLY_ERRORS) {
+        fileName = outputName(name, directory);
+        if (writeAssemblyFiles(fileName, result, options) < 0) {
+            status = "io-error";
+        }
+        free(fileName);
+    }
+
+    fprintf(out, "status %s %d\n", status, result->diagnostics.count);
+    for (i = 0; i < result->diagnostics.count; i++) {
+        fprintf(out, "%s %d %s\n", result->diagnostics.items[i].warning ? "warning" : "error",
+                result->diagnostics.items[i].line, result->diagnostics.items[i].message);
+    }
+    if (options->printStats && (result->status == ASSEMBLY_SUCCESS || result->status == ASSEMBLY_ERRORS)) {
+        fputs("stats ", out);
+        printStatsJson(out, name, &result->stats);
+    }
+    fputs("end\n", out);
+    fflush(out);
+}
+
+/* Serves assemble requests read from a stream, answering on another stream. */
+int serveStream(FILE *in, FILE *out, assemblerContext *context, const assemblerOptions *options) {
+    char request[MAX_REQUEST_LENGTH], *cursor, *command, *name, *argument, *directory, *end;
+    byteBuffer inlineSource;
+    sourceBuffer source;
+    int outcome = SESSION_END, c;
+    long length;
+
+    /* The buffer of inline sources is reused by every request of the session */
+    initByteBuffer(&inlineSource);
+
+    while (fgets(request, sizeof(request), in) != NULL) {
+        end = strchr(request, '\n');
+        if (end == NULL && !feof(in)) {
+            /* Skip the rest of a request that does not fit */
+            while ((c = fgetc(in)) != EOF && c != '\n') {
+            }
+            answerFailure(out, "bad-request", "Request too long", "");
+            continue;
+        }
+        if (end != NULL) {
+            *end = '\0';
+        }
+        if (end != NULL && end > request && end[-1] == '\r') {
+            end[-1] = '\0';
+        }
+
+        cursor = request;
+        command = nextRequestWord(&cursor);
+        if (command == NULL) {
+            continue;  /* Empty lines are ignored */
+        }
+
+        if (strcmp(command, "quit") == 0) {
+            break;
+        } else if (strcmp(command, "shutdown") == 0) {
+            outcome = SESSION_SHUTDOWN;
+            break;
+        } else if (strcmp(command, "assemble") == 0 && (name = nextRequestWord(&cursor)) != NULL) {
+            directory = nextRequestWord(&cursor);
+            if (nextRequestWord(&cursor) != NULL) {
+                answerFailure(out, "bad-request", "Too many words in request: ", command);
+            } else if (!openSourceBuffer(name, &source)) {
+                answerFailure(out, "io-error", "Error opening source file: ", name);
+            } else {
+                assembleRequest(out, context, options, source.text, source.length, name, directory);
+                closeSourceBuffer(&source);
+            }
+        } else if (strcmp(command, "source") == 0 && (name = nextRequestWord(&cursor)) != NULL &&
+                   (argument = nextRequestWord(&cursor)) != NULL) {
+            length = strtol(argument, &end, 10);
+            directory = nextRequestWord(&cursor);
+            if (*end != '\0' || length < 0) {
+                answerFailure(out, "bad-request", "Invalid source length: ", argument);
+            } else if (length > MAX_SOURCE_LENGTH) {
+                /* The buffer is not grown for it, the bytes are dropped as they are read */
+                answerFailure(out, "bad-request", "Source too long: ", argument);
+                if (!skipSourceBytes(in, length)) {
+                    break;
+                }
+            } else {
+                /* The source follows the request, its bytes are read even when the request is refused */
+                inlineSource.length = 0;
+                if (fread(extendByteBuffer(&inlineSource, length), 1, length, in) != (size_t) length) {
+                    answerFailure(out, "bad-request", "Source shorter than its length: ", argument);
+                    break;
+                }
+                if (nextRequestWord(&cursor) != NULL) {
+                    answerFailure(out, "bad-request", "Too many words in request: ", command);
+                } else {
+                    assembleRequest(out, context, options, inlineSource.data, length, name, directory);
+                }
+            }
+        } else {
+            answerFailure(out, "bad-request", "Unknown request: ", command);
+        }
+    }
+
+    freeByteBuffer(&inlineSource);
+    return outcome;
+}
+
+/* Serves the clients of a Unix domain socket, one at a time, until one sends shutdown. */
+bool serveSocket(const char *path, assemblerContext *context, const assemblerOptions *options) {
+    struct sockaddr_un address;
+    struct stat status;
+    int listener, client, outcome = SESSION_END;
+    FILE *in, *out;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    /* Replace a socket left by a server that did not stop cleanly, but never another kind of file */
+    if (lstat(path, &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            fprintf(stderr, "Not a socket, refusing to replace it: %s\n", path);
+            return false;
+        }
+        unlink(path);
+    }
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0) {
+        fprintf(stderr, "Cannot listen on socket: %s\n", path);
+        if (listener >= 0) {
+            close(listener);
+        }
+        return false;
+    }
+
+    /* A client that goes away before reading its answer must not stop the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    while (outcome != SESSION_SHUTDOWN) {
+        client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Cannot accept a connection on socket: %s\n", path);
+            break;
+        }
+
+        /* Separate streams for reading and writing the same connection */
+        in = fdopen(client, "r");
+        out = fdopen(dup(client), "w");
+        if (in != NULL && out != NULL) {
+            outcome = serveStream(in, out, context, options);
+        }
+        if (in != NULL) {
+            fclose(in);
+        } else {
+            close(client);
+        }
+        if (out != NULL) {
+            fclose(out);
+        }
+    }
+
+    close(listener);
+    unlink(path);
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "assembler.h"
+#include "libassembler.h"
+
+#define MAX_REQUEST_LENGTH 4096
+#define MAX_SOURCE_LENGTH (1L << 28)  /* Longest inline source, in bytes */
+
+/* How a session with a client ended */
+#define SESSION_END 0             /* The client closed its input or sent quit */
+#define SESSION_SHUTDOWN 1        /* The client asked the server to stop */
+
+/*
+ * Serves assemble requests read from a stream, answering on another stream.
+ *
+ * Every request is one line of words separated by spaces, so paths may not contain spaces:
+ *
+ *   assemble <source file> [<output directory>]
+ *   source <name> <length> [<output directory>]    followed by <length> bytes of source
+ *   quit
+ *   shutdown
+ *
+ * The output files are named after the source file, or after the name of an inline
+ * source, and written next to it or to the output directory. An inline source longer than
+ * MAX_SOURCE_LENGTH is refused and its bytes are skipped. Every request is answered
+ * with:
+ *
+ *   status <ok|errors|expansion-failed|out-of-memory|io-error|bad-request> <number of messages>
+ *   error <source line> <message>                   once for each error
+ *   warning <source line> <message>                 once for each warning, in source order
+ *   stats <JSON object>                             with --stats=json
+ *   end
+ *
+ * The same context assembles every request, so its tables and buffers stay allocated
+ * from one request to the next.
+ *
+ * @param in The stream the requests are read from.
+ * @param out The stream the answers are written to.
+ * @param context The assembler context.
+ * @param options The command line options applied to every request.
+ * @return SESSION_END or SESSION_SHUTDOWN.
+ */
+int serveStream(FILE *in, FILE *out, assemblerContext *context, const assemblerOptions *options);
+
+/*
+ * Serves the clients of a Unix domain socket, one at a time, until one sends shutdown.
+ *
+ * Each connection is a session of serveStream. The socket file is created, replacing
+ * a stale socket, and removed when the server stops. A file at the path that is not
+ * a socket is left alone and the server does not start.
+ *
+ * @param path The path of the socket.
+ * @param context The assembler context.
+ * @param options The command line options applied to every request.
+ * @return true if the server ran, false if the socket could not be created.
+ */
+bool serveSocket(const char *path, assemblerContext *context, const assemblerOptions *options);
+
+#endif
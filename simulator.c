@@ -0,0 +1,475 @@
+/*
+ * simulator.c
+ *
+ * Description:
+ * Runs an assembled program on a simulation of the 15 bit machine. The
+ * program is loaded at the addresses of its object file into a memory of
+ * MEMORY_SIZE words, and runs from its first code word until a stop.
+ *
+ * Every instruction is decoded the first time it runs: its operands become
+ * pointers to the words they read and write, and its handler is kept with
+ * it, so running it again costs one jump to the handler. With GCC the
+ * handlers are reached by computed goto straight from the decoded
+ * instruction; other compilers go through a switch. A store into memory
+ * drops the decoded instructions covering the word, so code that changes
+ * itself is decoded again. The loop is compiled twice from simulatorLoop.h,
+ * and only the copy --profile runs counts the instructions.
+ *
+ * The machine:
+ * - Eight registers r0-r7 of 15 bits, and a flag set by cmp when both
+ *   operands are equal, tested by bne.
+ * - Words are 15 bit two's complement numbers; arithmetic wraps.
+ * - jsr pushes the return address on a stack of STACK_SIZE addresses
+ *   separate from the memory, and rts pops it.
+ * - prn prints its operand as a decimal number on a line of its own, red
+ *   reads one character from the standard input, -1 at its end.
+ *
+ * Usage:
+ *   ./simulator prog.ob                 runs the program
+ *   ./simulator --limit=1000000 prog.ob stops after a million instructions
+ *   ./simulator --profile prog.ob       also reports the instructions run most,
+ *                                       by source line when prog.map exists
+ * A program is read from its .ob file, or from its binary object file when
+ * its name ends with .bin. It must not refer to external symbols: link its
+ * modules first.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "assembler.h"
+#include "keywords.h"
+#include "machineCode.h"
+#include "objectFile.h"
+#include "outputFiles.h"
+#include "statistics.h"
+
+#define MEMORY_SIZE 4096          /* Words addressed by the 12 bit address field */
+#define STACK_SIZE 1024           /* Return addresses jsr can push */
+#define WORD_MASK 0x7FFF          /* The 15 bits of a word */
+#define SIGN_BIT 0x4000           /* The sign of a 15 bit word */
+#define IMMEDIATE_SIGN 0x800      /* The sign of a 12 bit immediate value */
+#define REGISTER_MASK 7           /* The bits of a register number in an operand word */
+#define MODE_MASK 0xF             /* The four addressing mode bits of an operand */
+#define OPERATION_MASK 0xF        /* The four opcode bits of an instruction */
+#define PROFILE_LINES 20          /* Hot spots shown by --profile */
+#define LONGEST_INSTRUCTION 3     /* Words of an instruction with two operand words */
+
+/* Decoded entries around the memory: before it for INVALIDATE, and one past it for a run off its end */
+#define DECODED_BEFORE (LONGEST_INSTRUCTION - 1)
+#define DECODED_ENTRIES (DECODED_BEFORE + MEMORY_SIZE + 1)
+
+/* Handlers besides the operations, numbered after OP_STOP */
+#define DECODE (OP_STOP + 1)      /* The instruction is decoded before it runs */
+#define INVALID (OP_STOP + 2)     /* The word is not an instruction that can run */
+#define HANDLERS (OP_STOP + 3)
+
+/* Outcomes of a run */
+#define RUN_STOPPED 0             /* The program reached a stop */
+#define RUN_FAILED 1              /* The program ran an invalid instruction, or misused the stack */
+#define RUN_LIMITED 2             /* The program ran the largest number of instructions allowed */
+
+/* Structure representing where an operand is read and written. */
+typedef struct {
+    unsigned short *word;     /* The word of the operand, NULL when its address is in a register */
+    unsigned short *base;     /* The register holding the address of the operand, for *r */
+    int address;              /* The address a direct operand names, the target of a jump */
+} decodedOperand;
+
+/* Structure representing an instruction decoded for the simulation. */
+typedef struct {
+#ifdef __GNUC__
+    const void *handler;      /* The code running the instruction */
+#endif
+    int operation;            /* The opcode, or DECODE or INVALID */
+    int next;                 /* Address of the next instruction */
+    decodedOperand source;    /* The source operand */
+    decodedOperand target;    /* The destination operand */
+    unsigned short values[2]; /* The values of immediate operands, which the operands point to */
+    unsigned long count;      /* Number of times the instruction ran */
+} decodedInstruction;
+
+/* Structure representing the state of the machine. */
+typedef struct {
+    unsigned short words[MEMORY_SIZE + REGISTERS];  /* The memory, followed by the registers */
+    unsigned short *registers;                     /* The registers, at the end of words */
+    decodedInstruction *decoded;                   /* The decoded instruction at each address, after padding */
+    int stack[STACK_SIZE];                         /* The return addresses */
+    int error;                                     /* Address of the instruction that failed, -1 when none did */
+    const char *message;                           /* Why the instruction failed */
+} machine;
+
+/* Number of operands of each operation */
+static const int operandCounts[OP_STOP + 1] = {2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0};
+
+/* Returns the addressing mode of the one-hot mode bits of an operand, -1 for none and -2 for a bad value. */
+static int decodeMode(int bits) {
+    switch (bits) {
+        case 0: return -1;
+        case 1: return IMMEDIATE;
+        case 2: return DIRECT;
+        case 4: return INDIRECT_REG;
+        case 8: return DIRECT_REG;
+        default: return -2;
+    }
+}
+
+/* Returns the 15 bit word of the 12 bit signed value of an operand word. */
+static unsigned short immediateValue(unsigned short word) {
+    unsigned short value = (unsigned short) ((word >> VAL_POSITION) & ADDRESS_MASK);
+    return (value & IMMEDIATE_SIGN) ? (unsigned short) (value | (WORD_MASK & ~ADDRESS_MASK)) : value;
+}
+
+/*
+ * Decodes an operand from its word.
+ * @param sim The machine.
+ * @param in The instruction of the operand.
+ * @param operand Receives the operand.
+ * @param mode The addressing mode of the operand.
+ * @param word The word of the operand.
+ * @param registerPosition The position of the register number in the word.
+ * @param slot Which value of the instruction holds an immediate operand.
+ * @return NULL if the operand is valid, otherwise why it is not.
+ */
+static const char *decodeOperand(machine *sim, decodedInstruction *in, decodedOperand *operand, int mode,
+                                 unsigned short word, int registerPosition, int slot) {
+    operand->word = NULL;
+    operand->base = NULL;
+    operand->address = 0;
+
+    switch (mode) {
+        case IMMEDIATE:
+            if ((word & ARE_MASK) != (1 << A_BIT)) {
+                return "Invalid immediate operand";
+            }
+            in->values[slot] = immediateValue(word);
+            operand->word = &in->values[slot];
+            return NULL;
+        case DIRECT:
+            if ((word & ARE_MASK) == (1 << E_BIT)) {
+                return "Unresolved external reference, link the program first";
+            }
+            if ((word & ARE_MASK) != (1 << R_BIT) && (word & ARE_MASK) != (1 << A_BIT)) {
+                return "Invalid direct operand";
+            }
+            operand->address = (word >> VAL_POSITION) & ADDRESS_MASK;
+            operand->word = &sim->words[operand->address];
+            return NULL;
+        case INDIRECT_REG:
+            operand->base = &sim->registers[(word >> registerPosition) & REGISTER_MASK];
+            return NULL;
+        default:
+            operand->word = &sim->registers[(word >> registerPosition) & REGISTER_MASK];
+            return NULL;
+    }
+}
+
+/*
+ * Decodes the instruction at an address.
+ * @param sim The machine.
+ * @param address The address of the first word of the instruction.
+ */
+static void decodeInstruction(machine *sim, int address) {
+    decodedInstruction *in = &sim->decoded[address];
+    const char *problem = NULL;
+    unsigned short word;
+    int operation, sourceMode, targetMode, operands, length;
+
+    in->operation = INVALID;
+    if (address >= MEMORY_SIZE) {
+        sim->message = "Program counter outside the memory";
+        return;
+    }
+
+    word = sim->words[address];
+    operation = (word >> OP_C_POSITION) & OPERATION_MASK;
+    sourceMode = decodeMode((word >> S_POSITION) & MODE_MASK);
+    targetMode = decodeMode((word >> D_POSITION) & MODE_MASK);
+    operands = (sourceMode >= 0) + (targetMode >= 0);
+
+    /* The operands fill the destination first */
+    if ((word & ARE_MASK) != (1 << A_BIT) || sourceMode == -2 || targetMode == -2 ||
+        operands != operandCounts[operation] || (operands == 1 && sourceMode >= 0)) {
+        sim->message = "Invalid instruction";
+        return;
+    }
+
+    /* Two register operands share one word */
+    length = 1 + operands;
+    if (operands == 2 && (sourceMode == INDIRECT_REG || sourceMode == DIRECT_REG) &&
+        (targetMode == INDIRECT_REG || targetMode == DIRECT_REG)) {
+        length = 2;
+    }
+    if (address + length > MEMORY_SIZE) {
+        sim->message = "Instruction past the end of the memory";
+        return;
+    }
+
+    if (operands == 2) {
+        problem = decodeOperand(sim, in, &in->source, sourceMode, sim->words[address + 1], S_REG_POSITION, 0);
+        if (problem == NULL) {
+            problem = decodeOperand(sim, in, &in->target, targetMode, sim->words[address + length - 1],
+                                    D_REG_POSITION, 1);
+        }
+    } else if (operands == 1) {
+        problem = decodeOperand(sim, in, &in->target, targetMode, sim->words[address + 1], D_REG_POSITION, 1);
+    }
+
+    /* lea takes the address of a label, the jumps go to a label or to the address in a register */
+    if (problem == NULL && operation == OP_LEA) {
+        if (sourceMode != DIRECT) {
+            problem = "lea needs a label as its source";
+        } else {
+            in->values[0] = (unsigned short) in->source.address;
+            in->source.word = &in->values[0];
+        }
+    }
+    if (problem == NULL && (operation == OP_JMP || operation == OP_BNE || operation == OP_JSR) &&
+        targetMode != DIRECT && targetMode != INDIRECT_REG) {
+        problem = "A jump needs a label or an indirect register";
+    }
+    if (problem == NULL && operation != OP_CMP && operation != OP_PRN && operation != OP_JMP &&
+        operation != OP_BNE && operation != OP_JSR && operands > 0 && targetMode == IMMEDIATE) {
+        problem = "An immediate operand cannot be written";
+    }
+
+    if (problem != NULL) {
+        sim->message = problem;
+        return;
+    }
+    in->operation = operation;
+    in->next = address + length;
+}
+
+/* Marks a decoded instruction to be decoded again before it runs */
+#ifdef __GNUC__
+#define REDECODE(in) ((in)->operation = DECODE, (in)->handler = handlers[DECODE])
+#else
+#define REDECODE(in) ((in)->operation = DECODE)
+#endif
+
+/*
+ * Drops the decoded instructions that cover a word written by the program: those starting at it and
+ * up to two words before it. The entries before address 0 are padding, so they need no bound check.
+ */
+#define INVALIDATE(sim, written) do { \
+        long address_ = (written) - (sim)->words; \
+        if (address_ < MEMORY_SIZE) { \
+            REDECODE(&(sim)->decoded[address_]); \
+            REDECODE(&(sim)->decoded[address_ - 1]); \
+            REDECODE(&(sim)->decoded[address_ - 2]); \
+        } \
+    } while (0)
+
+/* The word an operand reads and writes */
+#define OPERAND(sim, operand) ((operand).word != NULL ? (operand).word \
+                               : &(sim)->words[*(operand).base & ADDRESS_MASK])
+
+/* The address a jump goes to */
+#define JUMP_TARGET(operand) ((operand).base != NULL ? (*(operand).base & ADDRESS_MASK) : (operand).address)
+
+/* Sign extends a 15 bit word */
+#define SIGNED_WORD(word) ((word) & SIGN_BIT ? (long) (word) - (WORD_MASK + 1) : (long) (word))
+
+/*
+ * Dispatch: with GCC each handler jumps straight to the handler of the next instruction, otherwise
+ * every handler goes back to the switch.
+ */
+#ifdef __GNUC__
+#define HANDLER(operation, label) label:
+#define DISPATCH() __extension__ ({ goto *in->handler; })
+#else
+#define HANDLER(operation, label) case operation:
+#define DISPATCH() goto dispatch
+#endif
+
+/* Goes on to the instruction at an address, counting it when the loop is profiled */
+#define NEXT(address) do { \
+        in = &sim->decoded[(address)]; \
+        COUNT(in); \
+        if (--budget == 0) { \
+            goto limited; \
+        } \
+        DISPATCH(); \
+    } while (0)
+
+/* The loop every program runs, which counts nothing */
+#define PROFILED 0
+#define COUNT(in)
+#define UNCOUNT(in)
+#include "simulatorLoop.h"
+#undef PROFILED
+#undef COUNT
+#undef UNCOUNT
+
+/* The loop of --profile, which counts every instruction it runs; the last one did not complete */
+#define PROFILED 1
+#define COUNT(in) ((in)->count++)
+#define UNCOUNT(in) ((in)->count--)
+#include "simulatorLoop.h"
+
+/*
+ * Loads a program into the memory of the machine.
+ * @param sim The machine.
+ * @param module The program.
+ * @return true if the program fits in the memory, false otherwise.
+ */
+static bool loadProgram(machine *sim, objectModule *module) {
+    if (module->loadBase < 0 || module->loadBase + module->codeCount > MEMORY_SIZE ||
+        module->dataBase < 0 || module->dataBase + module->dataCount > MEMORY_SIZE) {
+        return false;
+    }
+    memset(sim->words, 0, sizeof(sim->words));
+    sim->registers = sim->words + MEMORY_SIZE;
+    memcpy(sim->words + module->loadBase, module->code, module->codeCount * sizeof(unsigned short));
+    memcpy(sim->words + module->dataBase, module->data, module->dataCount * sizeof(unsigned short));
+    return true;
+}
+
+/*
+ * Reads the source lines of the code addresses from a .map file.
+ * @param fileName The name of the .map file.
+ * @param lines Receives the source line of every address, 0 when unknown.
+ */
+static void readLineMap(const char *fileName, int *lines) {
+    int address, line, previous = -1, previousLine = 0, i;
+    FILE *file;
+
+    memset(lines, 0, MEMORY_SIZE * sizeof(int));
+    file = fopen(fileName, "r");
+    if (file == NULL) {
+        return;
+    }
+
+    /* A line covers the addresses up to the next record */
+    while (fscanf(file, "%d %d", &address, &line) == 2 && address >= 0 && address < MEMORY_SIZE) {
+        for (i = previous; i >= 0 && i < address; i++) {
+            lines[i] = previousLine;
+        }
+        previous = address;
+        previousLine = line;
+    }
+    for (i = previous; i >= 0 && i < MEMORY_SIZE; i++) {
+        lines[i] = previousLine;
+    }
+    fclose(file);
+}
+
+/* Orders addresses by the number of times their instruction ran, the most first. */
+static decodedInstruction *profiled;
+static int compareCounts(const void *a, const void *b) {
+    unsigned long countA = profiled[*(const int *) a].count, countB = profiled[*(const int *) b].count;
+    return countA < countB ? 1 : countA > countB ? -1 : *(const int *) a - *(const int *) b;
+}
+
+/*
+ * Prints the number of instructions run and the instructions run most.
+ * @param sim The machine after the run.
+ * @param mapFileName The .map file of the program.
+ * @param seconds The time the run took.
+ */
+static void printProfile(machine *sim, const char *mapFileName, double seconds) {
+    int *lines = allocateMemory(MEMORY_SIZE * sizeof(int));
+    int *addresses = allocateMemory(MEMORY_SIZE * sizeof(int));
+    unsigned long total = 0;
+    int count = 0, i;
+
+    for (i = 0; i < MEMORY_SIZE; i++) {
+        if (sim->decoded[i].count > 0) {
+            total += sim->decoded[i].count;
+            addresses[count++] = i;
+        }
+    }
+    profiled = sim->decoded;
+    qsort(addresses, count, sizeof(int), compareCounts);
+    readLineMap(mapFileName, lines);
+
+    fprintf(stderr, "Ran %lu instructions in %.3f seconds (%.1f million per second)\n", total, seconds,
+            seconds > 0 ? total / seconds / 1e6 : 0.0);
+    fprintf(stderr, "address   line        count   share\n");
+    for (i = 0; i < count && i < PROFILE_LINES; i++) {
+        fprintf(stderr, "   %04d  %5d  %11lu  %5.1f%%\n", addresses[i], lines[addresses[i]],
+                sim->decoded[addresses[i]].count, 100.0 * sim->decoded[addresses[i]].count / total);
+    }
+    free(lines);
+    free(addresses);
+}
+
+/*
+ * Main function of the simulator.
+ * @param argc The number of command-line arguments.
+ * @param argv The options and the program to run.
+ * @return 0 if the program reached a stop, otherwise 1.
+ */
+int main(int argc, char *argv[]) {
+    objectModule module;
+    machine *sim;
+    char *mapFileName, *end;
+    unsigned long limit = 0;
+    bool profile = false;
+    int first = 1, outcome;
+    double start;
+
+    /* Parse the options given before the file name */
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "--profile") == 0) {
+            profile = true;
+        } else if (strncmp(argv[first], "--limit=", 8) == 0) {
+            limit = strtoul(argv[first] + 8, &end, 10);
+            if (argv[first][8] == '\0' || *end != '\0') {
+                printf("Invalid limit: %s\n", argv[first] + 8);
+                return 1;
+            }
+        } else {
+            printf("Unknown option: %s\n", argv[first]);
+            return 1;
+        }
+        first++;
+    }
+
+    if (argc - first != 1) {
+        printf("Usage: %s [--limit=<instructions>] [--profile] <file.ob>\n", argv[0]);
+        return 1;
+    }
+
+    if (!readObjectModule(argv[first], &module)) {
+        fprintf(stderr, "Error reading program: %s\n", argv[first]);
+        return 1;
+    }
+    sim = allocateMemory(sizeof(machine));
+    if (!loadProgram(sim, &module)) {
+        fprintf(stderr, "Error: %s does not fit in the memory of %d words\n", argv[first], MEMORY_SIZE);
+        freeObjectModule(&module);
+        free(sim);
+        return 1;
+    }
+
+    /* The entry past the memory catches a run off its end, those before it let INVALIDATE clear the first words */
+    sim->decoded = allocateMemory(DECODED_ENTRIES * sizeof(decodedInstruction));
+    memset(sim->decoded, 0, DECODED_ENTRIES * sizeof(decodedInstruction));
+    sim->decoded += DECODED_BEFORE;
+    sim->error = -1;
+    sim->message = NULL;
+
+    start = currentTime();
+    outcome = profile ? runProfiled(sim, module.loadBase, limit) : run(sim, module.loadBase, limit);
+    fflush(stdout);
+    if (outcome == RUN_FAILED) {
+        fprintf(stderr, "Error at address %04d: %s\n", sim->error, sim->message);
+    } else if (outcome == RUN_LIMITED) {
+        fprintf(stderr, "Stopped after %lu instructions\n", limit);
+    }
+
+    if (profile) {
+        mapFileName = changeFileExtension(argv[first], ".map");
+        printProfile(sim, mapFileName, currentTime() - start);
+        free(mapFileName);
+    }
+
+    freeObjectModule(&module);
+    free(sim->decoded - DECODED_BEFORE);
+    free(sim);
+    return outcome == RUN_STOPPED ? 0 : 1;
+}
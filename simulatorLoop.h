@@ -0,0 +1,162 @@
+/*
+ * simulatorLoop.h
+ *
+ * Description:
+ * The dispatch loop of the simulator. simulator.c includes it twice: once
+ * with PROFILED set to 0 for the run every program gets, and once with
+ * PROFILED set to 1 for --profile, so only the profiling loop pays for
+ * counting the instructions. The file has no include guard on purpose;
+ * COUNT and UNCOUNT are defined by the includer.
+ */
+
+/*
+ * Runs the program until it stops.
+ * With PROFILED set the loop is runProfiled, which counts the instructions it runs for --profile;
+ * otherwise it is run, which counts nothing.
+ * @param sim The machine, with the program loaded.
+ * @param start The address of the first instruction.
+ * @param limit The largest number of instructions to run, 0 for no limit.
+ * @return RUN_STOPPED, RUN_FAILED or RUN_LIMITED.
+ */
+#if PROFILED
+static int runProfiled(machine *sim, int start, unsigned long limit) {
+#else
+static int run(machine *sim, int start, unsigned long limit) {
+#endif
+#ifdef __GNUC__
+    static const void *const handlers[HANDLERS] = {
+        __extension__ &&op_mov, __extension__ &&op_cmp, __extension__ &&op_add, __extension__ &&op_sub,
+        __extension__ &&op_lea, __extension__ &&op_clr, __extension__ &&op_not, __extension__ &&op_inc,
+        __extension__ &&op_dec, __extension__ &&op_jmp, __extension__ &&op_bne, __extension__ &&op_red,
+        __extension__ &&op_prn, __extension__ &&op_jsr, __extension__ &&op_rts, __extension__ &&op_stop,
+        __extension__ &&op_decode, __extension__ &&op_invalid
+    };
+#endif
+    decodedInstruction *in;
+    unsigned short *operand, value;
+    unsigned long budget = limit > 0 ? limit + 1 : 0;
+    bool zero = false;
+    int depth = 0, c, i;
+
+    for (i = -DECODED_BEFORE; i <= MEMORY_SIZE; i++) {
+        REDECODE(&sim->decoded[i]);
+    }
+
+    NEXT(start);
+#ifndef __GNUC__
+dispatch:
+    switch (in->operation) {
+#endif
+
+    HANDLER(OP_MOV, op_mov)
+        operand = OPERAND(sim, in->target);
+        *operand = *OPERAND(sim, in->source);
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_CMP, op_cmp)
+        zero = *OPERAND(sim, in->source) == *OPERAND(sim, in->target);
+        NEXT(in->next);
+
+    HANDLER(OP_ADD, op_add)
+        operand = OPERAND(sim, in->target);
+        *operand = (unsigned short) ((*operand + *OPERAND(sim, in->source)) & WORD_MASK);
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_SUB, op_sub)
+        operand = OPERAND(sim, in->target);
+        *operand = (unsigned short) ((*operand - *OPERAND(sim, in->source)) & WORD_MASK);
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_LEA, op_lea)
+        operand = OPERAND(sim, in->target);
+        *operand = in->values[0];
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_CLR, op_clr)
+        operand = OPERAND(sim, in->target);
+        *operand = 0;
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_NOT, op_not)
+        operand = OPERAND(sim, in->target);
+        *operand = (unsigned short) (~*operand & WORD_MASK);
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_INC, op_inc)
+        operand = OPERAND(sim, in->target);
+        *operand = (unsigned short) ((*operand + 1) & WORD_MASK);
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_DEC, op_dec)
+        operand = OPERAND(sim, in->target);
+        *operand = (unsigned short) ((*operand - 1) & WORD_MASK);
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_JMP, op_jmp)
+        NEXT(JUMP_TARGET(in->target));
+
+    HANDLER(OP_BNE, op_bne)
+        NEXT(zero ? in->next : JUMP_TARGET(in->target));
+
+    HANDLER(OP_RED, op_red)
+        operand = OPERAND(sim, in->target);
+        c = getchar();
+        *operand = (unsigned short) (c & WORD_MASK);
+        INVALIDATE(sim, operand);
+        NEXT(in->next);
+
+    HANDLER(OP_PRN, op_prn)
+        value = *OPERAND(sim, in->target);
+        printf("%ld\n", SIGNED_WORD(value));
+        NEXT(in->next);
+
+    HANDLER(OP_JSR, op_jsr)
+        if (depth == STACK_SIZE) {
+            sim->message = "Stack overflow";
+            goto failed;
+        }
+        sim->stack[depth++] = in->next;
+        NEXT(JUMP_TARGET(in->target));
+
+    HANDLER(OP_RTS, op_rts)
+        if (depth == 0) {
+            sim->message = "rts with an empty stack";
+            goto failed;
+        }
+        NEXT(sim->stack[--depth]);
+
+    HANDLER(OP_STOP, op_stop)
+        return RUN_STOPPED;
+
+    HANDLER(DECODE, op_decode)
+        /* The instruction runs once it is decoded, it was counted already */
+        decodeInstruction(sim, (int) (in - sim->decoded));
+#ifdef __GNUC__
+        in->handler = handlers[in->operation];
+#endif
+        DISPATCH();
+
+    HANDLER(INVALID, op_invalid)
+        goto failed;
+
+#ifndef __GNUC__
+    }
+#endif
+
+failed:
+    sim->error = (int) (in - sim->decoded);
+    UNCOUNT(in);
+    return RUN_FAILED;
+
+limited:
+    UNCOUNT(in);
+    return RUN_LIMITED;
+}
@@ -0,0 +1,76 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "allocation.h"
+#include "sourceReader.h"
+
+#define READ_CHUNK 65536
+
+/* Reads the whole file into a growing buffer, for files that cannot be mapped. */
+static bool readWholeFile(int fd, sourceBuffer *source) {
+    long capacity = READ_CHUNK;
+    ssize_t count;
+
+    source->text = allocateMemory(capacity);
+    source->length = 0;
+    source->mapped = false;
+
+    while ((count = read(fd, source->text + source->length, capacity - source->length)) > 0) {
+        source->length += count;
+
+        /* Double the buffer when it is full */
+        if (source->length == capacity) {
+            capacity *= 2;
+            source->text = reallocateMemory(source->text, capacity);
+        }
+    }
+    return count == 0;
+}
+
+/* Opens a source file and maps its text, or reads it when it cannot be mapped. */
+bool openSourceBuffer(const char *fileName, sourceBuffer *source) {
+    struct stat status;
+    bool success;
+    int fd;
+
+    fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    /* Map regular files that are not empty */
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+        void *text = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text != MAP_FAILED) {
+            source->text = text;
+            source->length = status.st_size;
+            source->mapped = true;
+            close(fd);
+            return true;
+        }
+    }
+
+    success = readWholeFile(fd, source);
+    close(fd);
+    if (!success) {
+        free(source->text);
+    }
+    return success;
+}
+
+/* Releases the text of a source file. */
+void closeSourceBuffer(sourceBuffer *source) {
+    if (source->mapped) {
+        munmap(source->text, source->length);
+    } else {
+        free(source->text);
+    }
+    source->text = NULL;
+    source->length = 0;
+}
@@ -0,0 +1,36 @@
+#ifndef SOURCE_READER_H
+#define SOURCE_READER_H
+
+#include <stdbool.h>
+
+#include "header.h"
+
+/* Structure representing the whole text of a source file in memory. */
+typedef struct {
+    char *text;               /* The text of the file, not null terminated */
+    long length;              /* Number of characters in the text */
+    bool mapped;              /* Whether the text is mapped from the file or read into a buffer */
+} sourceBuffer;
+
+/*
+ * Opens a source file and makes its whole text available in memory.
+ *
+ * Regular files are memory mapped, so the text is never copied. Other files,
+ * such as pipes, are read into a buffer.
+ *
+ * @param fileName The name of the source file.
+ * @param source Receives the text of the file.
+ * @return true if the file was read, false otherwise.
+ */
+bool openSourceBuffer(const char *fileName, sourceBuffer *source);
+
+/*
+ * Releases the text of a source file.
+ *
+ * Every span pointing into the text becomes invalid.
+ *
+ * @param source The source opened with openSourceBuffer.
+ */
+void closeSourceBuffer(sourceBuffer *source);
+
+#endif
@@ -0,0 +1,65 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <time.h>
+
+#include "statistics.h"
+
+/* Resets all the timing and counters. */
+void initStats(assemblerStats *stats) {
+    stats->expandTime = 0;
+    stats->firstPassTime = 0;
+    stats->resolveTime = 0;
+    stats->outputTime = 0;
+    stats->linesRead = 0;
+    stats->macrosDefined = 0;
+    stats->macrosExpanded = 0;
+    stats->symbolsAdded = 0;
+    stats->symbolLookups = 0;
+    stats->wordsEmitted = 0;
+    stats->bytesWritten = 0;
+    stats->cacheStatus = CACHE_UNUSED;
+}
+
+/* Returns the time of a monotonic clock in seconds. */
+double currentTime() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* Names of the uses of the cache in the statistics, by status */
+static const char *cacheStatusNames[] = {"unused", "hit", "miss", "invalid"};
+
+/* Writes a string as a JSON string literal. */
+static void printJsonString(FILE *file, const char *s) {
+    fputc('"', file);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(file, "\\%c", *s);
+        } else if ((unsigned char) *s < 0x20) {
+            fprintf(file, "\\u%04x", (unsigned char) *s);
+        } else {
+            fputc(*s, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/* Writes the statistics of a file as one JSON object on a single line. */
+void printStatsJson(FILE *file, const char *sourceFileName, assemblerStats *stats) {
+    fprintf(file, "{\"file\":");
+    printJsonString(file, sourceFileName);
+    fprintf(file, ",\"expand_seconds\":%.6f,\"first_pass_seconds\":%.6f"
+                  ",\"resolve_seconds\":%.6f,\"output_seconds\":%.6f",
+            stats->expandTime, stats->firstPassTime, stats->resolveTime, stats->outputTime);
+    fprintf(file, ",\"lines_read\":%ld,\"macros_defined\":%ld,\"macros_expanded\":%ld"
+                  ",\"symbols_added\":%ld,\"find_symbol_calls\":%ld,\"words_emitted\":%ld"
+                  ",\"bytes_written\":%ld",
+            stats->linesRead, stats->macrosDefined, stats->macrosExpanded, stats->symbolsAdded,
+            stats->symbolLookups, stats->wordsEmitted, stats->bytesWritten);
+    if (stats->cacheStatus != CACHE_UNUSED) {
+        fprintf(file, ",\"cache\":\"%s\"", cacheStatusNames[stats->cacheStatus]);
+    }
+    fputs("}\n", file);
+}
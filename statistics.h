@@ -0,0 +1,51 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <stdio.h>
+
+/* Use of the cache by a file, see cache.h */
+#define CACHE_UNUSED 0            /* No cache directory was given */
+#define CACHE_HIT 1               /* The files were restored from the cache */
+#define CACHE_MISS 2              /* The source was not in the cache and was assembled */
+#define CACHE_INVALID 3           /* The entry of the source was stale or corrupted, it was assembled */
+
+/* Structure holding the timing and counters of assembling one file. */
+typedef struct {
+    double expandTime;        /* Seconds spent expanding macros */
+    double firstPassTime;     /* Seconds spent in the first pass */
+    double resolveTime;       /* Seconds spent resolving the fixups */
+    double outputTime;        /* Seconds spent writing the output files */
+    long linesRead;           /* Lines read from the source file */
+    long macrosDefined;       /* Macros defined in the source file */
+    long macrosExpanded;      /* Macro calls replaced by the macro lines */
+    long symbolsAdded;        /* Symbols added to the symbol table */
+    long symbolLookups;       /* Calls to findSymbol */
+    long wordsEmitted;        /* Code and data words produced */
+    long bytesWritten;        /* Bytes written to the output files */
+    int cacheStatus;          /* One of the CACHE_ uses */
+} assemblerStats;
+
+/*
+ * Resets all the timing and counters.
+ *
+ * @param stats The statistics to reset.
+ */
+void initStats(assemblerStats *stats);
+
+/*
+ * Returns the time of a monotonic clock, to measure the wall time of a phase.
+ *
+ * @return The current time in seconds.
+ */
+double currentTime();
+
+/*
+ * Writes the statistics of a file as one JSON object on a single line.
+ *
+ * @param file The stream to write to.
+ * @param sourceFileName The name of the assembled file.
+ * @param stats The statistics of the file.
+ */
+void printStatsJson(FILE *file, const char *sourceFileName, assemblerStats *stats);
+
+#endif
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocation.h"
+#include "processorUtils.h"
+#include "stringPool.h"
+
+/* Returns the index slot of the given string, or the empty slot where it would be inserted. */
+static int findPoolSlot(stringPool *pool, const char *start, int length) {
+    int mask = pool->indexSize - 1;
+    int slot = (int) (hashString(start, length) & mask);
+    int id;
+
+    while ((id = pool->index[slot]) != NO_STRING &&
+           (pool->lengths[id] != length || memcmp(pool->text + pool->offsets[id], start, length) != 0)) {
+        slot = (slot + 1) & mask;  /* Linear probing */
+    }
+    return slot;
+}
+
+/* Allocates an index of the given size with every slot empty. */
+static void allocateIndex(stringPool *pool, int size) {
+    int i;
+
+    pool->indexSize = size;
+    pool->index = allocateMemory(size * sizeof(int));
+    for (i = 0; i < size; i++) {
+        pool->index[i] = NO_STRING;
+    }
+}
+
+/* Initializes an empty string pool */
+stringPool *initStringPool() {
+    stringPool *pool = allocateMemory(sizeof(stringPool));
+
+    pool->count = 0;
+    pool->capacity = INITIAL_POOL_STRINGS;
+    pool->offsets = allocateMemory(pool->capacity * sizeof(long));
+    pool->lengths = allocateMemory(pool->capacity * sizeof(int));
+    pool->textLength = 0;
+    pool->textCapacity = INITIAL_POOL_TEXT;
+    pool->text = allocateMemory(pool->textCapacity);
+
+    /* The index is kept at most half full */
+    allocateIndex(pool, 2 * INITIAL_POOL_STRINGS);
+    return pool;
+}
+
+/* Returns the ID of a string without adding it */
+int findString(stringPool *pool, span name) {
+    return pool->index[findPoolSlot(pool, name.start, name.length)];
+}
+
+/* Returns the ID of a string, adding it to the pool the first time it is seen */
+int internString(stringPool *pool, span name) {
+    int slot = findPoolSlot(pool, name.start, name.length), id, i;
+
+    if (pool->index[slot] != NO_STRING) {
+        return pool->index[slot];
+    }
+
+    /* Grow the arrays and the text geometrically */
+    if (pool->count == pool->capacity) {
+        pool->capacity *= 2;
+        pool->offsets = reallocateMemory(pool->offsets, pool->capacity * sizeof(long));
+        pool->lengths = reallocateMemory(pool->lengths, pool->capacity * sizeof(int));
+    }
+    while (pool->textLength + name.length + 1 > pool->textCapacity) {
+        pool->textCapacity *= 2;
+        pool->text = reallocateMemory(pool->text, pool->textCapacity);
+    }
+
+    /* Copy the string once, the ID is its position in the arrays */
+    id = pool->count++;
+    pool->offsets[id] = pool->textLength;
+    pool->lengths[id] = name.length;
+    memcpy(pool->text + pool->textLength, name.start, name.length);
+    pool->text[pool->textLength + name.length] = '\0';
+    pool->textLength += name.length + 1;
+    pool->index[slot] = id;
+
+    /* Double the index and insert every string again when it is half full */
+    if (2 * pool->count > pool->indexSize) {
+        free(pool->index);
+        pool->index = NULL;
+        allocateIndex(pool, 2 * pool->indexSize);
+        for (i = 0; i < pool->count; i++) {
+            pool->index[findPoolSlot(pool, pool->text + pool->offsets[i], pool->lengths[i])] = i;
+        }
+    }
+    return id;
+}
+
+/* Returns an interned string */
+const char *poolString(stringPool *pool, int id) {
+    return pool->text + pool->offsets[id];
+}
+
+/* Returns the length of an interned string */
+int poolStringLength(stringPool *pool, int id) {
+    return pool->lengths[id];
+}
+
+/* Removes every string from the pool, keeping its memory */
+void clearStringPool(stringPool *pool) {
+    int i;
+
+    pool->count = 0;
+    pool->textLength = 0;
+    for (i = 0; i < pool->indexSize; i++) {
+        pool->index[i] = NO_STRING;
+    }
+}
+
+/* Frees the pool and all its strings */
+void freeStringPool(stringPool *pool) {
+    free(pool->text);
+    free(pool->offsets);
+    free(pool->lengths);
+    free(pool->index);
+    free(pool);
+}
@@ -0,0 +1,84 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include "header.h"
+
+#define INITIAL_POOL_STRINGS 64
+#define INITIAL_POOL_TEXT 1024
+#define NO_STRING (-1)
+
+/* Structure representing a pool of interned identifiers.
+ * Every distinct string is stored once and numbered densely from 0 in the order it was
+ * first interned, so tables keyed by identifier can be plain arrays indexed by the ID. */
+typedef struct {
+    char *text;               /* The strings, each followed by a null character */
+    long textLength;          /* Number of characters used in text */
+    long textCapacity;        /* Number of characters text can hold */
+    long *offsets;            /* Offset of each string in text, by ID */
+    int *lengths;             /* Length of each string, by ID */
+    int count;                /* Number of strings in the pool */
+    int capacity;             /* Number of strings the arrays can hold */
+    int *index;               /* Open addressing hash index: IDs, or NO_STRING */
+    int indexSize;            /* Number of slots in the index, a power of two */
+} stringPool;
+
+/*
+ * Initializes an empty string pool.
+ *
+ * @return A pointer to the newly created pool.
+ */
+stringPool *initStringPool();
+
+/*
+ * Returns the ID of a string, adding it to the pool the first time it is seen.
+ *
+ * @param pool A pointer to the pool.
+ * @param name The string to intern.
+ * @return The ID of the string.
+ */
+int internString(stringPool *pool, span name);
+
+/*
+ * Returns the ID of a string without adding it.
+ *
+ * @param pool A pointer to the pool.
+ * @param name The string to look up.
+ * @return The ID of the string, or NO_STRING if it was never interned.
+ */
+int findString(stringPool *pool, span name);
+
+/*
+ * Returns an interned string.
+ *
+ * The pointer is valid until the next string is interned.
+ *
+ * @param pool A pointer to the pool.
+ * @param id The ID of the string.
+ * @return The null terminated string.
+ */
+const char *poolString(stringPool *pool, int id);
+
+/*
+ * Returns the length of an interned string.
+ *
+ * @param pool A pointer to the pool.
+ * @param id The ID of the string.
+ * @return The number of characters in the string.
+ */
+int poolStringLength(stringPool *pool, int id);
+
+/*
+ * Removes every string from the pool, keeping its memory for the strings interned next.
+ *
+ * @param pool A pointer to the pool.
+ */
+void clearStringPool(stringPool *pool);
+
+/*
+ * Frees the pool and all its strings.
+ *
+ * @param pool A pointer to the pool.
+ */
+void freeStringPool(stringPool *pool);
+
+#endif
@@ -1,109 +1,121 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "allocation.h"
 #include "symbolTable.h"
 
 
-/* todo - to delete temporary debug */
-void printSymbolTable(symbolTable *symTable) {
+/* Initializes a new symbol table */
+symbolTable *initSymbolTable() {
+    symbolTable *table = allocateMemory(sizeof(symbolTable));
+
+    table->count = 0;
+    table->lookups = 0;
+    table->capacity = INITIAL_SYMBOLS_CAPACITY;
+    table->symbols = allocateMemory(table->capacity * sizeof(Symbol));
+    table->names = initStringPool();
+    table->firstSymbol = NULL;
+    table->firstCapacity = 0;
+    table->dataBase = 0;
+
+    return table;
+}
+
+/* Removes every symbol and name from the table, keeping its memory */
+void clearSymbolTable(symbolTable *symTable) {
     int i;
 
-    printf("------------------------------------------\n");
-    printf("%-20s %-10s %-10s\n", "Name", "Address", "Type");
-    printf("------------------------------------------\n");
+    /* The pool also holds the names of the macros, which have no slot to reset */
     for (i = 0; i < symTable->count; i++) {
-        printf("%-20s %-10d %-10s\n", symTable->symbols[i]->name, symTable->symbols[i]->address,
-               symTable->symbols[i]->type);
+        symTable->firstSymbol[symTable->symbols[i].nameId] = NO_SYMBOL;
     }
-    printf("------------------------------------------\n");
+    clearStringPool(symTable->names);
+    symTable->count = 0;
+    symTable->lookups = 0;
+    symTable->dataBase = 0;
 }
 
+/* Interns a name in the string pool of the symbol table */
+int internName(symbolTable *symTable, span name) {
+    int id, i;
 
-/* Initializes a new symbol table */
-symbolTable *initSymbolTable() {
-    symbolTable *table = malloc(sizeof(symbolTable));
-    if (table == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
+    if (name.length > MAX_LABEL_LENGTH - 1) {
+        name.length = MAX_LABEL_LENGTH - 1;
     }
-
-    table->count = 0;
-    table->symbols = NULL;
-
-    return table;
+    id = internString(symTable->names, name);
+
+    /* Every name ID has a slot in the array of first symbols */
+    if (id >= symTable->firstCapacity) {
+        int oldCapacity = symTable->firstCapacity;
+        symTable->firstCapacity = symTable->names->capacity;
+        symTable->firstSymbol = reallocateMemory(symTable->firstSymbol, symTable->firstCapacity * sizeof(int));
+        for (i = oldCapacity; i < symTable->firstCapacity; i++) {
+            symTable->firstSymbol[i] = NO_SYMBOL;
+        }
+    }
+    return id;
 }
 
+/* Returns the name of a symbol */
+const char *symbolName(symbolTable *symTable, Symbol *symbol) {
+    return poolString(symTable->names, symbol->nameId);
+}
 
 /* Adds a new symbol to the symbol table */
-void addSymbol(symbolTable *symTable, char *name, char *type, int address) {
+void addSymbol(symbolTable *symTable, int nameId, int segment, int flags, int address) {
     Symbol *newSymbol;
     if (symTable == NULL) {
-        fprintf(stderr, "Error: Symbol table is NULL.\n");
-        exit(EXIT_FAILURE);
+        return;
     }
 
-    /* Allocate memory for the new symbol */
-    newSymbol = malloc(sizeof(Symbol));
-    if (newSymbol == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
+    /* Grow the symbols array geometrically */
+    if (symTable->count == symTable->capacity) {
+        symTable->capacity *= 2;
+        symTable->symbols = reallocateMemory(symTable->symbols, symTable->capacity * sizeof(Symbol));
     }
 
-    /* Copy the symbol's name and type into allocated memory */
-    strncpy(newSymbol->name, name, MAX_LABEL_LENGTH - 1);
-    newSymbol->name[MAX_LABEL_LENGTH - 1] = '\0';
+    /* Fill the next free symbol */
+    newSymbol = &symTable->symbols[symTable->count];
+    newSymbol->nameId = nameId;
     newSymbol->address = address;
-    strncpy(newSymbol->type, type, MAX_TYPE_LENGTH - 1);
-    newSymbol->type[MAX_TYPE_LENGTH - 1] = '\0';
-
-    /* Reallocate memory for the symbols array */
-    symTable->symbols = realloc(symTable->symbols, (symTable->count + 1) * sizeof(Symbol *));
-    if (symTable->symbols == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
-    }
+    newSymbol->segment = (unsigned char) segment;
+    newSymbol->flags = (unsigned char) flags;
 
-    /* Add the new symbol to the symbols array */
-    symTable->symbols[symTable->count] = newSymbol;
+    /* Index the name, unless it is already in the table */
+    if (symTable->firstSymbol[nameId] == NO_SYMBOL) {
+        symTable->firstSymbol[nameId] = symTable->count;
+    }
     symTable->count++;
 }
 
-/* Finds a symbol by its name in the symbol table. */
-Symbol* findSymbol(symbolTable *symTable, char *name) {
-    int i;
+/* Returns the absolute address of a symbol */
+int symbolAddress(symbolTable *symTable, Symbol *symbol) {
+    return symbol->segment == SEGMENT_DATA ? symTable->dataBase + symbol->address : symbol->address;
+}
+
+/* Finds a symbol by the ID of its name. */
+Symbol* findSymbol(symbolTable *symTable, int nameId) {
+    int position;
     if (symTable == NULL) {
         fprintf(stderr, "Error: Symbol table is NULL.\n");
         return NULL;
     }
 
-    /* Search for the symbol with the given name */
-    for (i = 0; i < symTable->count; i++) {
-        if (strcmp(symTable->symbols[i]->name, name) == 0) {
-            return symTable->symbols[i];
-        }
-    }
-
-    return NULL;
+    symTable->lookups++;
+    position = symTable->firstSymbol[nameId];
+    return position == NO_SYMBOL ? NULL : &symTable->symbols[position];
 }
 
 /* Frees all memory allocated for the symbol table */
 void freeSymbolTable(symbolTable *symTable) {
-    int i;
-
     if (symTable == NULL) {
         fprintf(stderr, "Error: Symbol table is NULL.\n");
         return;
     }
 
-    /* Free memory allocated for each symbol */
-    for (i = 0; i < symTable->count; i++) {
-        free(symTable->symbols[i]);
-    }
-
-    /* Free memory allocated for the symbols array */
+    /* Free memory allocated for the symbols, the names and the index */
     free(symTable->symbols);
-    symTable->count = 0;
-
+    free(symTable->firstSymbol);
+    freeStringPool(symTable->names);
+    free(symTable);
 }
-
-
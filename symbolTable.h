@@ -2,20 +2,41 @@
 #define SYMBOL_TABLE_H
 
 #include "header.h"
+#include "stringPool.h"
 
-#define MAX_TYPE_LENGTH 10
+#define INITIAL_SYMBOLS_CAPACITY 16
+#define NO_SYMBOL (-1)
+
+/* Segments a symbol is defined in */
+#define SEGMENT_NONE 0            /* External symbols are not defined in this file */
+#define SEGMENT_CODE 1            /* Addresses are instruction counters */
+#define SEGMENT_DATA 2            /* Addresses are relative to the start of the data segment */
+
+/* Symbol attribute bits */
+#define SYMBOL_ENTRY 1            /* Named by a .entry directive */
+#define SYMBOL_EXTERNAL 2         /* Declared by a .extern directive */
 
 /* Structure representing a symbol in the symbol table. */
 typedef struct {
-    char name[MAX_LABEL_LENGTH];  /* The name of the symbol */
-    int address;                  /* The address associated with the symbol */
-    char type[MAX_TYPE_LENGTH];   /* The type of the symbol */
+    int nameId;                   /* The ID of the name of the symbol in the string pool */
+    int address;                  /* The address of the symbol, relative to its segment */
+    unsigned char segment;        /* SEGMENT_NONE, SEGMENT_CODE or SEGMENT_DATA */
+    unsigned char flags;          /* SYMBOL_ENTRY and SYMBOL_EXTERNAL bits */
 } Symbol;
 
-/* Structure representing the symbol table. */
+/* Structure representing the symbol table.
+ * The symbols are kept in insertion order in one array that grows geometrically.
+ * Names are interned in a string pool, and the position of the first symbol of every
+ * name is kept in an array indexed by the name's ID. */
 typedef struct {
-    Symbol **symbols; /* Array of pointers to symbols */
-    int count;        /* Number of symbols in the table */
+    Symbol *symbols;    /* Array of symbols in insertion order */
+    int count;          /* Number of symbols in the table */
+    int capacity;       /* Number of symbols the array can hold */
+    stringPool *names;  /* The names of the symbols, of the symbol operands and of the macros */
+    int *firstSymbol;   /* Position in symbols of the first symbol of each name ID, or NO_SYMBOL */
+    int firstCapacity;  /* Number of name IDs the array can hold */
+    int dataBase;       /* Address of the first data word, known at the end of the first pass */
+    long lookups;       /* Number of calls to findSymbol */
 } symbolTable;
 
 /*
@@ -27,41 +48,80 @@ typedef struct {
  */
 symbolTable *initSymbolTable();
 
+/*
+ * Removes every symbol and name from the table.
+ *
+ * The memory of the table is kept, so a table can be reused for the next source.
+ *
+ * @param symTable A pointer to the symbol table.
+ */
+void clearSymbolTable(symbolTable *symTable);
+
 /*
  * Frees memory allocated for the symbol table.
  *
  * This function deallocates all memory used by the symbol table, including
- * individual symbols and the table itself.
+ * individual symbols, the string pool and the table itself.
  *
  * @param symTable A pointer to the symbol table to be freed.
  */
 void freeSymbolTable(symbolTable *symTable);
 
+/*
+ * Interns a name in the string pool of the symbol table.
+ *
+ * A name longer than a label can be is cut to its first MAX_LABEL_LENGTH - 1 characters.
+ *
+ * @param symTable A pointer to the symbol table.
+ * @param name The name.
+ * @return The ID of the name.
+ */
+int internName(symbolTable *symTable, span name);
+
+/*
+ * Returns the name of a symbol.
+ *
+ * @param symTable A pointer to the symbol table.
+ * @param symbol The symbol.
+ * @return The null terminated name.
+ */
+const char *symbolName(symbolTable *symTable, Symbol *symbol);
+
 /*
  * Adds a new symbol to the symbol table.
  *
  * This function creates a new symbol and adds it to the symbol table.
  *
  * @param symTable A pointer to the symbol table.
- * @param name The name of the symbol to be added.
- * @param type The type of the symbol.
- * @param address The address associated with the symbol.
+ * @param nameId The ID of the name of the symbol to be added, from internName.
+ * @param segment The segment the symbol is defined in.
+ * @param flags The attribute bits of the symbol.
+ * @param address The address of the symbol, relative to its segment.
  */
-void addSymbol(symbolTable *symTable, char *name, char *type, int address);
+void addSymbol(symbolTable *symTable, int nameId, int segment, int flags, int address);
 
 /*
- * Finds a symbol by its name in the symbol table.
+ * Returns the absolute address of a symbol.
  *
- * This function searches for a symbol with the given name in the symbol table.
+ * Data symbols are relocated by the address of the data segment.
  *
  * @param symTable A pointer to the symbol table.
- * @param name The name of the symbol to search for.
- * @return A pointer to the symbol if found, or NULL if not found.
+ * @param symbol The symbol.
+ * @return The address of the symbol.
  */
-Symbol* findSymbol(symbolTable *symTable, char *name);
-
+int symbolAddress(symbolTable *symTable, Symbol *symbol);
 
-void updateSymbolType(symbolTable *symTable, char *name);
+/*
+ * Finds a symbol by the ID of its name.
+ *
+ * This function is a single array access. If the name was added more than once,
+ * the first symbol added with it is returned.
+ * The returned pointer is valid until the next symbol is added.
+ *
+ * @param symTable A pointer to the symbol table.
+ * @param nameId The ID of the name of the symbol to search for.
+ * @return A pointer to the symbol if found, or NULL if not found.
+ */
+Symbol* findSymbol(symbolTable *symTable, int nameId);
 
-void printSymbolTable(symbolTable *symTable); /* temporary debug */
 #endif
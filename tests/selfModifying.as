@@ -0,0 +1,11 @@
+; The add rewrites the immediate operand of the prn, one word after the start
+; of the instruction, so the prn must be decoded again: it prints 1 then 2.
+MAIN: lea P, r1
+      inc r1
+      clr r3
+P:    prn #1
+      add #8, *r1
+      inc r3
+      cmp r3, #2
+      bne P
+      stop